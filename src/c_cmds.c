@@ -50,6 +50,7 @@
 #include "doomstat.h"
 #include "g_game.h"
 #include "hu_stuff.h"
+#include "i_capture.h"
 #include "i_gamepad.h"
 #include "i_swap.h"
 #include "i_system.h"
@@ -58,6 +59,7 @@
 #include "m_config.h"
 #include "m_menu.h"
 #include "m_misc.h"
+#include "m_profile.h"
 #include "m_random.h"
 #include "p_inter.h"
 #include "p_local.h"
@@ -93,6 +95,7 @@ extern boolean  animatedliquid;
 extern boolean  brightmaps;
 extern boolean  capfps;
 extern boolean  centerweapon;
+extern boolean  columnmajor;
 extern boolean  corpses_mirror;
 extern boolean  corpses_moreblood;
 extern boolean  corpses_slide;
@@ -189,6 +192,7 @@ extern char     *pixelsize;
 extern int      pixelwidth;
 extern int      playerbob;
 extern char     *playername;
+extern int      renderthreads;
 extern int      runcount;
 extern char     *savegamefolder;
 #if defined(SDL20)
@@ -202,6 +206,7 @@ extern int      selectedepisode;
 extern int      selectedexpansion;
 extern int      selectedsavegame;
 extern int      selectedskilllevel;
+extern boolean  setsizeneeded;
 extern boolean  shadows;
 #if defined(WIN32)
 extern boolean  showmemory;
@@ -210,11 +215,13 @@ extern boolean  smoketrails;
 extern int      snd_maxslicetime_ms;
 extern boolean  spritefixes;
 extern boolean  swirlingliquid;
+extern int      targetfps;
 extern char     *timidity_cfg_path;
 extern boolean  translucency;
 #if !defined(WIN32) || !defined(SDL20)
 extern char     *videodriver;
 #endif
+extern int      viewscale;
 #if defined(SDL20)
 extern boolean  vsync;
 #endif
@@ -331,8 +338,10 @@ static boolean C_ResurrectCondition(char *, char *, char *);
 static boolean C_VolumeCondition(char *, char *, char *);
 
 static void C_AlwaysRun(char *, char *, char *);
+static void C_Benchmark(char *, char *, char *);
 static void C_Bind(char *, char *, char *);
 static void C_Bool(char *, char *, char *);
+static void C_Capture(char *, char *, char *);
 static void C_Clear(char *, char *, char *);
 static void C_CmdList(char *, char *, char *);
 static void C_ConDump(char *, char *, char *);
@@ -357,8 +366,10 @@ static void C_MapList(char *, char *, char *);
 static void C_MaxBloodSplats(char *, char *, char *);
 static void C_NoClip(char *, char *, char *);
 static void C_NoTarget(char *, char *, char *);
+static void C_Perf(char *, char *, char *);
 static void C_PixelSize(char *, char *, char *);
 static void C_Quit(char *, char *, char *);
+static void C_RenderStats(char *, char *, char *);
 static void C_Resurrect(char *, char *, char *);
 static void C_Save(char *, char *, char *);
 #if defined(SDL20)
@@ -436,13 +447,16 @@ consolecmd_t consolecmds[] =
     CVAR_BOOL (am_grid, C_BoolCondition, C_Bool, am_grid, GRID, "Toggle the grid in the automap."),
     CVAR_BOOL (am_rotatemode, C_BoolCondition, C_Bool, am_rotatemode, ROTATEMODE, "Toggle rotate mode in the automap."),
     //CVAR_BOOL (autosave, C_BoolCondition, C_Bool, autosave, AUTOSAVE, "Toggle autosaving at the start of each map."),
+    CMD       (benchmark, C_NoCondition, C_Benchmark, 1, "[~frames~]", "Time the renderer's drawers, vissprite sorting, lump lookups and palette expansion."),
     CMD       (bind, C_NoCondition, C_Bind, 2, "[~control~ [+~action~]]", "Bind an action to a control."),
+    CMD       (capture, C_NoCondition, C_Capture, 1, "[stop|~filename~.y4m]", "Capture every tic to a Y4M video file."),
     CMD       (clear, C_NoCondition, C_Clear, 0, "", "Clear the console."),
     CMD       (cmdlist, C_NoCondition, C_CmdList, 1, "[~searchstring~]", "Display a list of console commands."),
     CVAR_BOOL (com_showfps, C_BoolCondition, C_Bool, showfps, NONE, "Toggle showing the average frames per second."),
 #if defined(WIN32)
     CVAR_BOOL(com_showmemoryusage, C_BoolCondition, C_Bool, showmemory, NONE, "Toggle showing the memory usage."),
 #endif
+    CVAR_BOOL (com_showperf, C_BoolCondition, C_Bool, showperf, NONE, "Toggle showing how long each stage of a frame takes."),
     CMD       (condump, C_NoCondition, C_ConDump, 1, "[~filename~.txt]", "Dump the console to a file."),
     CMD       (cvarlist, C_NoCondition, C_CvarList, 1, "[~searchstring~]", "Display a list of console variables."),
     CMD       (endgame, C_GameCondition, C_EndGame, 0, "", "End a game."),
@@ -490,12 +504,14 @@ consolecmd_t consolecmds[] =
     CVAR_BOOL (messages, C_BoolCondition, C_Bool, messages, MESSAGES, "Toggle messages."),
     CMD       (noclip, C_GameCondition, C_NoClip, 1, "[on|off]", "Toggle no clipping mode."),
     CMD       (notarget, C_GameCondition, C_NoTarget, 1, "[on|off]", "Toggle no target mode."),
+    CMD       (perf, C_NoCondition, C_Perf, 1, "[reset|stop|~filename~.csv]", "Show how long each stage of a frame takes, or log it to a file."),
     CVAR_STR  (playername, C_PlayerNameCondition, C_Str, playername, "The name of the player used in messages."),
     CVAR_BOOL (pm_alwaysrun, C_BoolCondition, C_AlwaysRun, alwaysrun, ALWAYSRUN, "Toggle always run."),
     CVAR_BOOL (pm_centerweapon, C_BoolCondition, C_Bool, centerweapon, CENTERWEAPON, "Toggle the centering of the player's weapon when firing."),
     CVAR_INT  (pm_walkbob, C_NoCondition, C_Int, CF_PERCENT, playerbob, 0, PLAYERBOB, "The amount the player bobs when walking."),
     CMD       (quit, C_NoCondition, C_Quit, 0, "", "Quit "PACKAGE_NAME"."),
     CVAR_BOOL (r_brightmaps, C_BoolCondition, C_Bool, brightmaps, BRIGHTMAPS, "Toggle brightmaps on certain wall textures."),
+    CVAR_BOOL (r_columnmajor, C_BoolCondition, C_Bool, columnmajor, COLUMNMAJOR, "Toggle drawing the player's view into a column-major buffer."),
     CVAR_BOOL (r_corpses_mirrored, C_BoolCondition, C_Bool, corpses_mirror, CORPSES_MIRROR, "Toggle corpses being randomly mirrored."),
     CVAR_BOOL (r_corpses_moreblood, C_BoolCondition, C_Bool, corpses_moreblood, CORPSES_MOREBLOOD, "Toggle blood splats around corpses when a map is loaded."),
     CVAR_BOOL (r_corpses_slide, C_BoolCondition, C_Bool, corpses_slide, CORPSES_SLIDE, "Toggle corpses reacting to barrel and rocket explosions."),
@@ -514,7 +530,11 @@ consolecmd_t consolecmds[] =
     CVAR_BOOL (r_rockettrails, C_BoolCondition, C_Bool, smoketrails, SMOKETRAILS, "Toggle rocket trails behind player and Cyberdemon rockets."),
     CVAR_INT  (r_screensize, C_IntCondition, C_ScreenSize, CF_NONE, screensize, 0, SCREENSIZE, "The screen size."),
     CVAR_BOOL (r_shadows, C_BoolCondition, C_Bool, shadows, SHADOWS, "Toggle sprites casting shadows."),
+    CVAR_INT  (r_targetfps, C_IntCondition, C_Int, CF_NONE, targetfps, 0, TARGETFPS, "The frame rate the player's view is scaled down to keep (0 = off)."),
+    CVAR_INT  (r_threads, C_IntCondition, C_Int, CF_NONE, renderthreads, 0, RENDERTHREADS, "The number of threads used to render the player's view."),
     CVAR_BOOL (r_translucency, C_BoolCondition, C_Bool, translucency, TRANSLUCENCY, "Toggle translucency in sprites and textures."),
+    CVAR_INT  (r_viewscale, C_NoCondition, C_Int, CF_PERCENT | CF_READONLY, viewscale, 0, VIEWSCALE, "The scale the player's view is currently rendered at."),
+    CMD       (renderstats, C_GameCondition, C_RenderStats, 0, "", "Show statistics about the last frame rendered."),
     CMD       (resurrect, C_ResurrectCondition, C_Resurrect, 0, "", "Resurrect the player."),
     CVAR_INT  (runcount, C_NoCondition, C_Int, CF_READONLY, runcount, 0, NONE, "The number of times "PACKAGE_NAME" has been run."),
     CVAR_INT  (s_maxslicetime, C_NoCondition, C_Int, CF_NONE, snd_maxslicetime_ms, 0, SND_MAXSLICETIME_MS, "The maximum slice time of sound effects."),
@@ -608,6 +628,24 @@ static void C_DisplayBinds(char *action, int value, controltype_t type, int coun
     }
 }
 
+static void C_Benchmark(char *cmd, char *parm1, char *parm2)
+{
+    int frames = 100;
+
+    if (parm1[0])
+        sscanf(parm1, "%10i", &frames);
+
+    frames = BETWEEN(1, frames, 10000);
+
+    R_BenchmarkDrawers(frames);
+    R_BenchmarkSortVisSprites(frames);
+    W_BenchmarkLumpLookups(frames);
+
+#if defined(SDL20)
+    I_BenchmarkPaletteExpansion(frames);
+#endif
+}
+
 static void C_Bind(char *cmd, char *parm1, char *parm2)
 {
     if (!parm1[0])
@@ -785,6 +823,25 @@ static void C_Bool(char *cmd, char *parm1, char *parm2)
     }
 }
 
+static void C_Capture(char *cmd, char *parm1, char *parm2)
+{
+    if (!strcasecmp(parm1, "stop") || (!parm1[0] && capturing))
+    {
+        if (capturing)
+        {
+            C_Output("Stopped capturing to the file %s.", uppercase(I_CaptureName()));
+            I_StopCapture();
+        }
+    }
+    else if (parm1[0])
+    {
+        if (I_StartCapture(parm1))
+            C_Output("Capturing every tic to the file %s.", uppercase(parm1));
+        else
+            C_Warning("%s couldn't be opened.", uppercase(parm1));
+    }
+}
+
 extern int      consolestrings;
 
 static void C_Clear(char *cmd, char *parm1, char *parm2)
@@ -1062,7 +1119,7 @@ static void C_Gamma(char *cmd, char *parm1, char *parm2)
             }
             --gammaindex;
 
-            I_SetPalette((byte *)W_CacheLumpName("PLAYPAL", PU_CACHE) + st_palette * 768);
+            I_SetPlayPalette(st_palette);
             M_SaveDefaults();
         }
     }
@@ -1162,6 +1219,7 @@ static void C_GraphicDetail(char *cmd, char *parm1, char *parm2)
         if (value == 0 || value == 1)
         {
             graphicdetail = !!value;
+            setsizeneeded = true;
             M_SaveDefaults();
         }
     }
@@ -1693,6 +1751,50 @@ static void C_NoTarget(char *cmd, char *parm1, char *parm2)
     HU_PlayerMessage(((player->cheats & CF_NOTARGET) ? s_STSTR_NTON : s_STSTR_NTOFF), false);
 }
 
+static void C_Perf(char *cmd, char *parm1, char *parm2)
+{
+    M_StartProfiling();
+
+    if (!strcasecmp(parm1, "reset"))
+    {
+        M_ProfileReset();
+        C_Output("The frame times have been reset.");
+    }
+    else if (!strcasecmp(parm1, "stop"))
+    {
+        if (M_ProfileLogName())
+        {
+            C_Output("Stopped logging frame times to the file %s.", uppercase(M_ProfileLogName()));
+            M_StopProfileLog();
+        }
+    }
+    else if (parm1[0])
+    {
+        if (M_StartProfileLog(parm1))
+            C_Output("Logging frame times to the file %s.", uppercase(parm1));
+        else
+            C_Warning("%s couldn't be opened.", uppercase(parm1));
+    }
+    else
+    {
+        int     tabs[8] = { 60, 115, 170, 225, 280, 335, 0, 0 };
+        int     i;
+
+        C_Output("Frame times in milliseconds over the last %i frames:", M_ProfileFrames());
+        C_TabbedOutput(tabs, "Stage\tMin\tAvg\t50th\t95th\t99th\tMax");
+
+        for (i = 0; i < NUMPROFILESTAGES; ++i)
+        {
+            profilestats_t      stats;
+
+            M_GetProfileStats((profilestage_t)i, &stats);
+            C_TabbedOutput(tabs, "%s\t%.2f\t%.2f\t%.2f\t%.2f\t%.2f\t%.2f", profilestagenames[i],
+                stats.min / 1000.0, stats.avg / 1000.0, stats.p50 / 1000.0, stats.p95 / 1000.0,
+                stats.p99 / 1000.0, stats.max / 1000.0);
+        }
+    }
+}
+
 static void C_PixelSize(char *cmd, char *parm1, char *parm2)
 {
     if (parm1[0])
@@ -1712,6 +1814,7 @@ static void C_PixelSize(char *cmd, char *parm1, char *parm2)
             while (SCREENHEIGHT % pixelheight)
                 --pixelheight;
 
+            setsizeneeded = true;
             M_SaveDefaults();
         }
     }
@@ -1729,6 +1832,17 @@ static void C_Quit(char *cmd, char *parm1, char *parm2)
     I_Quit(true);
 }
 
+static void C_RenderStats(char *cmd, char *parm1, char *parm2)
+{
+    C_Output("%s visplanes in %s hash buckets.", commify(renderstats.visplanes),
+        commify(renderstats.visplanebuckets));
+    C_Output("%s bytes of visplanes initialized.", commify(renderstats.visplanebytes));
+    C_Output("%s of %s (%i%%) plane rows found in the cache.", commify(renderstats.mapplanehits),
+        commify(renderstats.mapplanehits + renderstats.mapplanemisses),
+        (renderstats.mapplanehits + renderstats.mapplanemisses ? renderstats.mapplanehits * 100
+        / (renderstats.mapplanehits + renderstats.mapplanemisses) : 0));
+}
+
 static boolean C_ResurrectCondition(char *cmd, char *parm1, char *parm2)
 {
     return (gamestate == GS_LEVEL && players[0].playerstate == PST_DEAD);
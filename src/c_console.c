@@ -57,6 +57,7 @@
 #include "m_cheat.h"
 #include "m_menu.h"
 #include "m_misc.h"
+#include "m_profile.h"
 #include "p_local.h"
 #include "SDL.h"
 #include "SDL_mixer.h"
@@ -778,6 +779,35 @@ void C_Drawer(void)
             CloseHandle(hProcess);
         }
 #endif
+
+        if (showperf)
+        {
+            int     y = CONSOLETEXTY + (showfps && fps ? CONSOLELINEHEIGHT : 0);
+            int     i;
+
+#if defined(WIN32)
+            if (showmemory)
+                y += CONSOLELINEHEIGHT;
+#endif
+
+            C_DrawOverlayText(SCREENWIDTH - C_TextWidth("Avg/99th/Max ms") - CONSOLETEXTX + 2, y,
+                "Avg/99th/Max ms", consolememorycolor);
+
+            for (i = 0; i < NUMPROFILESTAGES; ++i)
+            {
+                static char buffer[64];
+
+                M_snprintf(buffer, sizeof(buffer), "%s %.2f/%.2f/%.2f", profilestagenames[i],
+                    profilesummary[i].avg / 1000.0, profilesummary[i].p99 / 1000.0,
+                    profilesummary[i].max / 1000.0);
+
+                y += CONSOLELINEHEIGHT;
+                C_DrawOverlayText(SCREENWIDTH - C_TextWidth(buffer) - CONSOLETEXTX + 2, y, buffer,
+                    consolememorycolor);
+            }
+
+            blurred = false;
+        }
     }
 }
 
@@ -61,6 +61,7 @@
 #include "f_wipe.h"
 #include "g_game.h"
 #include "hu_stuff.h"
+#include "i_capture.h"
 #include "i_gamepad.h"
 #include "i_swap.h"
 #include "i_system.h"
@@ -70,6 +71,7 @@
 #include "m_config.h"
 #include "m_menu.h"
 #include "m_misc.h"
+#include "m_profile.h"
 #include "p_local.h"
 #include "p_saveg.h"
 #include "p_setup.h"
@@ -183,8 +185,6 @@ gamestate_t     wipegamestate = GS_TITLESCREEN;
 
 extern boolean  setsizeneeded;
 extern boolean  message_on;
-extern int      graphicdetail;
-extern int      viewheight2;
 extern boolean  loadedgame;
 
 void R_ExecuteSetViewSize(void);
@@ -211,7 +211,7 @@ void D_Display(void)
     }
 
     // save the current screen if about to wipe
-    if ((wipe = (gamestate != wipegamestate || forcewipe)))
+    if ((wipe = ((gamestate != wipegamestate || forcewipe) && !timingdemo)))
     {
         wipe_StartScreen();
         if (forcewipe)
@@ -223,7 +223,7 @@ void D_Display(void)
     if (gamestate != GS_LEVEL)
     {
         if (gamestate != oldgamestate && !splashscreen)
-            I_SetPalette(W_CacheLumpName("PLAYPAL", PU_CACHE));
+            I_SetPlayPalette(0);
 
         switch (gamestate)
         {
@@ -242,15 +242,21 @@ void D_Display(void)
     }
     else if (gametic)
     {
+        M_ProfileBegin(PROFILE_HUD);
         HU_Erase();
 
-        ST_Drawer(viewheight == SCREENHEIGHT, true);
+        ST_Drawer(scaledviewheight == SCREENHEIGHT, true);
+        M_ProfileEnd(PROFILE_HUD);
 
         // draw the view directly
         R_RenderPlayerView(&players[0]);
 
         if (automapactive)
+        {
+            M_ProfileBegin(PROFILE_AUTOMAP);
             AM_Drawer();
+            M_ProfileEnd(PROFILE_AUTOMAP);
+        }
 
         // see if the border needs to be initially drawn
         if (oldgamestate != GS_LEVEL)
@@ -276,10 +282,10 @@ void D_Display(void)
                     --borderdrawcount;
                 }
             }
-            if (graphicdetail == LOW)
-                V_LowGraphicDetail(viewheight2);
         }
+        M_ProfileBegin(PROFILE_HUD);
         HU_Drawer();
+        M_ProfileEnd(PROFILE_HUD);
     }
 
     menuactivestate = menuactive;
@@ -296,7 +302,7 @@ void D_Display(void)
 
             if (widescreen)
                 V_DrawPatchWithShadow((ORIGINALWIDTH - SHORT(patch->width)) / 2,
-                    viewwindowy / 2 + (viewheight / 2 - SHORT(patch->height)) / 2, patch, false);
+                    viewwindowy / 2 + (scaledviewheight / 2 - SHORT(patch->height)) / 2, patch, false);
             else
                 V_DrawPatchWithShadow((ORIGINALWIDTH - SHORT(patch->width)) / 2,
                     (ORIGINALHEIGHT - SHORT(patch->height)) / 2, patch, false);
@@ -304,7 +310,7 @@ void D_Display(void)
         else
         {
             if (widescreen)
-                M_DrawCenteredString(viewwindowy / 2 + (viewheight / 2 - 16) / 2, s_M_PAUSED);
+                M_DrawCenteredString(viewwindowy / 2 + (scaledviewheight / 2 - 16) / 2, s_M_PAUSED);
             else
                 M_DrawCenteredString((ORIGINALHEIGHT - 16) / 2, s_M_PAUSED);
         }
@@ -319,7 +325,10 @@ void D_Display(void)
     // normal update
     if (!wipe)
     {
+        M_ProfileBegin(PROFILE_BLIT);
         I_FinishUpdate();       // page flip or blit buffer
+        M_ProfileEnd(PROFILE_BLIT);
+        M_ProfileFrame();
         return;
     }
 
@@ -333,8 +342,8 @@ void D_Display(void)
         do
         {
             nowtime = I_GetTime();
-            tics = nowtime - wipestart;
-            I_Sleep(1);
+            if ((tics = nowtime - wipestart) <= 0)
+                I_Sleep(1);
         }
         while (tics <= 0);
 
@@ -345,7 +354,11 @@ void D_Display(void)
         C_Drawer();
 
         M_Drawer();             // menu is drawn even on top of wipes
+
+        M_ProfileBegin(PROFILE_BLIT);
         I_FinishUpdate();       // page flip or blit buffer
+        M_ProfileEnd(PROFILE_BLIT);
+        M_ProfileFrame();
     }
     while (!done);
 
@@ -372,8 +385,12 @@ void D_DoomLoop(void)
             S_UpdateSounds(players[0].mo);  // move positional sounds
 
         // Update display, next frame, with current state.
-        if (screenvisible)
+        if (screenvisible && !fastdemo)
+        {
             D_Display();
+            if (timingdemo)
+                ++demoframes;
+        }
     }
 }
 
@@ -389,7 +406,6 @@ static patch_t  *splshtxt;
 static patch_t  *titlelump;
 static patch_t  *creditlump;
 static byte     *splshpal;
-static byte     *playpal;
 
 //
 // D_PageTicker
@@ -476,7 +492,7 @@ void D_DoAdvanceTitle(void)
             pagetic = 20 * TICRATE;
             if (splashscreen)
             {
-                I_SetPalette(playpal);
+                I_SetPlayPalette(0);
                 splashscreen = false;
                 if (!TITLEPIC)
                     M_StartControlPanel();
@@ -1371,6 +1387,9 @@ static void D_DoomMainSetup(void)
 #endif
         I_Error("Can't find %s.", uppercase(PACKAGE_WAD));
 
+    // Generate the WAD hash table. Speed things up a bit.
+    W_GenerateHashTable();
+
     if (!CheckPackageWADVersion())
         I_Error("Wrong version of %s.", uppercase(PACKAGE_WAD));
 
@@ -1406,9 +1425,6 @@ static void D_DoomMainSetup(void)
 
     bfgedition = (DMENUPIC && W_CheckNumForName("M_ACPT") >= 0);
 
-    // Generate the WAD hash table. Speed things up a bit.
-    W_GenerateHashTable();
-
     D_IdentifyVersion();
     InitGameVersion();
     D_ProcessDehInWad();
@@ -1592,6 +1608,22 @@ static void D_DoomMainSetup(void)
     else
         startloadgame = -1;
 
+    p = M_CheckParmWithArgs("-record", 1);
+    if (p)
+    {
+        G_RecordDemo(myargv[p + 1]);
+
+        // start recording a new game straight away
+        if (!autostart)
+        {
+            if (gamemode == commercial)
+                M_snprintf(lumpname, sizeof(lumpname), "MAP%02i", startmap);
+            else
+                M_snprintf(lumpname, sizeof(lumpname), "E%iM%i", startepisode, startmap);
+            autostart = true;
+        }
+    }
+
     P_BloodSplatSpawner = ((maxbloodsplats == UNLIMITED ? P_SpawnBloodSplat :
         (maxbloodsplats ? P_SpawnBloodSplat2 : P_NullBloodSplatSpawner)));
 
@@ -1627,9 +1659,29 @@ static void D_DoomMainSetup(void)
     splshpal = (byte *)W_CacheLumpName("SPLSHPAL", PU_CACHE);
     titlelump = W_CacheLumpName(TITLEPIC ? "TITLEPIC" : (DMENUPIC ? "DMENUPIC" : "INTERPIC"), PU_CACHE);
     creditlump = W_CacheLumpName("CREDIT", PU_CACHE);
-    playpal = (byte *)W_CacheLumpName("PLAYPAL", PU_CACHE);
 
-    if (gameaction != ga_loadgame)
+    if ((p = M_CheckParmWithArgs("-capture", 1)))
+    {
+        if (I_StartCapture(myargv[p + 1]))
+            C_Output("Found -CAPTURE parameter on command-line. Every tic will be captured to %s.",
+                uppercase(myargv[p + 1]));
+        else
+            C_Warning("%s couldn't be opened.", uppercase(myargv[p + 1]));
+    }
+
+    if ((p = M_CheckParmWithArgs("-timedemo", 1)))
+        G_TimeDemo(myargv[p + 1], false);
+    else if ((p = M_CheckParmWithArgs("-fastdemo", 1)))
+        G_TimeDemo(myargv[p + 1], true);
+    else if ((p = M_CheckParmWithArgs("-playdemo", 1)))
+        G_DeferredPlayDemo(myargv[p + 1]);
+
+    if (gameaction == ga_playdemo)
+    {
+        I_InitKeyboard();
+        noinput = false;
+    }
+    else if (gameaction != ga_loadgame)
     {
         if (autostart)
         {
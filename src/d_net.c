@@ -41,6 +41,7 @@
 #include "d_main.h"
 #include "m_argv.h"
 #include "m_menu.h"
+#include "m_profile.h"
 #include "i_system.h"
 #include "i_timer.h"
 #include "i_video.h"
@@ -173,6 +174,26 @@ void TryRunTics(void)
     int         availabletics;
     int         counts;
 
+    // run exactly one tic per frame, regardless of the time, when timing a demo
+    if (timingdemo)
+    {
+        ticcmd_t        cmd;
+
+        I_StartTic();
+        D_ProcessEvents();
+        M_Ticker();
+
+        memset(&cmd, 0, sizeof(ticcmd_t));
+        G_BuildTiccmd(&cmd);
+        netcmds[maketic++ % BACKUPTICS] = cmd;
+
+        M_ProfileBegin(PROFILE_TICKER);
+        G_Ticker();
+        M_ProfileEnd(PROFILE_TICKER);
+        gametic++;
+        return;
+    }
+
     // get real tics
     entertic = I_GetTime() / ticdup;
     realtics = entertic - oldentertics;
@@ -222,7 +243,9 @@ void TryRunTics(void)
             if (advancetitle)
                 D_DoAdvanceTitle();
 
+            M_ProfileBegin(PROFILE_TICKER);
             G_Ticker();
+            M_ProfileEnd(PROFILE_TICKER);
             gametic++;
 
             // modify command for duplicated tics
@@ -85,4 +85,11 @@ typedef uint8_t byte;
 
 #define arrlen(array) (sizeof(array) / sizeof(*array))
 
+// Per-thread storage for renderer state, so each render thread has its own copy.
+#if defined(_MSC_VER)
+#define THREADLOCAL     __declspec(thread)
+#else
+#define THREADLOCAL     __thread
+#endif
+
 #endif
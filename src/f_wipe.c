@@ -36,11 +36,17 @@
 ========================================================================
 */
 
+#include "i_system.h"
 #include "i_video.h"
 #include "f_wipe.h"
+#include "m_fixed.h"
 #include "v_video.h"
 #include "z_zone.h"
 
+#if defined(X86_CPU)
+#include <immintrin.h>
+#endif
+
 //
 // SCREEN WIPE PACKAGE
 //
@@ -49,56 +55,154 @@ static byte *wipe_scr_start;
 static byte *wipe_scr_end;
 static byte *wipe_scr;
 
-void wipe_shittyColMajorXform(short *array)
+//
+// The screen melts in bands of MELTBANDWIDTH pixels, each with its own offset.
+// Every tic, the rows of the end screen a band has uncovered are copied in,
+// and the start screen is copied in again below them. Neighbouring bands
+// that are in step are copied together, so the screens stay row-major.
+//
+#define MELTBANDWIDTH   4
+#define MELTBANDS       (SCREENWIDTH / MELTBANDWIDTH)
+
+typedef struct
+{
+    int         x;              // first pixel of the run of bands
+    int         width;          // width of the run in pixels
+    int         top;            // first row of the end screen to copy
+    int         y;              // rows of the end screen uncovered so far
+} meltrun_t;
+
+static int              *y;
+static int              speed;
+static meltrun_t        meltruns[MELTBANDS];
+static void             (*meltrows)(meltrun_t *, int);
+
+static __inline void wipe_copySegment(byte *dest, const byte *src, int width)
 {
-    int   x, y;
-    short *dest = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, 0);
+    do
+    {
+        memcpy(dest, src, MELTBANDWIDTH);
+        dest += MELTBANDWIDTH;
+        src += MELTBANDWIDTH;
+    } while (width -= MELTBANDWIDTH);
+}
 
-    for (y = 0; y < SCREENHEIGHT; y++)
-        for (x = 0; x < SCREENWIDTH / 2; x++)
-            dest[x * SCREENHEIGHT + y] = array[y * SCREENWIDTH / 2 + x];
+//
+// wipe_meltRows
+// Copies the rows of the end screen each run of bands has uncovered, and
+// then the start screen below them, a row segment at a time.
+//
+static void wipe_meltRows(meltrun_t *runs, int numruns)
+{
+    int i;
 
-    memcpy(array, dest, SCREENWIDTH * SCREENHEIGHT);
+    for (i = 0; i < numruns; i++)
+    {
+        meltrun_t   *run = &runs[i];
+        int         row = run->top;
+        int         width = run->width;
+        byte        *dest = wipe_scr + row * SCREENWIDTH + run->x;
+        const byte  *src = wipe_scr_end + row * SCREENWIDTH + run->x;
 
-    Z_Free(dest);
+        for (; row < run->y; row++, dest += SCREENWIDTH, src += SCREENWIDTH)
+            wipe_copySegment(dest, src, width);
+
+        src = wipe_scr_start + run->x;
+
+        for (; row < SCREENHEIGHT; row++, dest += SCREENWIDTH, src += SCREENWIDTH)
+            wipe_copySegment(dest, src, width);
+    }
 }
 
-static int *y;
-static int speed;
+#if defined(X86_CPU)
+TARGET("sse2") static __inline void wipe_copySegmentSSE2(byte *dest, const byte *src, int width)
+{
+    while (width >= 16)
+    {
+        _mm_storeu_si128((__m128i *)dest, _mm_loadu_si128((const __m128i *)src));
+        dest += 16;
+        src += 16;
+        width -= 16;
+    }
+    if (width >= 8)
+    {
+        _mm_storel_epi64((__m128i *)dest, _mm_loadl_epi64((const __m128i *)src));
+        dest += 8;
+        src += 8;
+        width -= 8;
+    }
+    if (width)
+        memcpy(dest, src, MELTBANDWIDTH);
+}
+
+TARGET("sse2") static void wipe_meltRowsSSE2(meltrun_t *runs, int numruns)
+{
+    int i;
+
+    for (i = 0; i < numruns; i++)
+    {
+        meltrun_t   *run = &runs[i];
+        int         row = run->top;
+        int         width = run->width;
+        byte        *dest = wipe_scr + row * SCREENWIDTH + run->x;
+        const byte  *src = wipe_scr_end + row * SCREENWIDTH + run->x;
+
+        for (; row < run->y; row++, dest += SCREENWIDTH, src += SCREENWIDTH)
+            wipe_copySegmentSSE2(dest, src, width);
+
+        src = wipe_scr_start + run->x;
+
+        for (; row < SCREENHEIGHT; row++, dest += SCREENWIDTH, src += SCREENWIDTH)
+            wipe_copySegmentSSE2(dest, src, width);
+    }
+}
+#endif
 
 boolean wipe_initMelt(void)
 {
     int i;
+    int band;
 
     speed = (SCREENHEIGHT - (SBARHEIGHT * widescreen)) / 16;
 
     // copy start screen to main screen
     memcpy(wipe_scr, wipe_scr_start, SCREENWIDTH * SCREENHEIGHT);
 
-    // makes this wipe faster (in theory)
-    // to have stuff in column-major format
-    wipe_shittyColMajorXform((short *)wipe_scr_start);
-    wipe_shittyColMajorXform((short *)wipe_scr_end);
-
-    // setup initial column positions
+    // setup initial band positions
     // (y < 0 => not ready to scroll yet)
-    y = Z_Malloc(SCREENWIDTH * sizeof(int), PU_STATIC, 0);
-    y[0] = y[1] = -(rand() % 16);
-    for (i = 2; i < SCREENWIDTH - 1; i += 2)
-        y[i] = y[i + 1] = BETWEEN(-15, y[i - 1] + (rand() % 3) - 1, 0);
+    // Offsets are drawn from rand() just as many times as they always have
+    // been, so the melt looks the same, but only one is kept per band.
+    y = Z_Malloc(MELTBANDS * sizeof(int), PU_STATIC, 0);
+    y[0] = band = -(rand() % 16);
+    for (i = 1; i < SCREENWIDTH / 2; i++)
+    {
+        band = BETWEEN(-15, band + (rand() % 3) - 1, 0);
+        if (i < MELTBANDS)
+            y[i] = band;
+    }
+
+#if defined(X86_CPU)
+    meltrows = ((I_GetCPUFeatures() & CPU_SSE2) ? wipe_meltRowsSSE2 : wipe_meltRows);
+#else
+    meltrows = wipe_meltRows;
+#endif
 
     return false;
 }
 
 boolean wipe_doMelt(int tics)
 {
-    boolean done = true;
+    boolean     done = true;
+    int         top[MELTBANDS];
+    int         numruns = 0;
+    int         i;
 
-    while (tics--)
-    {
-        int i;
+    // the first row of the end screen each band uncovers
+    for (i = 0; i < MELTBANDS; i++)
+        top[i] = MAX(0, y[i]);
 
-        for (i = 0; i < SCREENWIDTH / 2; i++)
+    while (tics--)
+        for (i = 0; i < MELTBANDS; i++)
         {
             if (y[i] < 0)
             {
@@ -108,34 +212,36 @@ boolean wipe_doMelt(int tics)
             }
             if (y[i] < SCREENHEIGHT)
             {
-                int   j;
-                int   dy = (y[i] < 16 ? y[i] + 1 : speed);
-                int   idx = 0;
-
-                short *s = &((short *)wipe_scr_end)[i * SCREENHEIGHT + y[i]];
-                short *d = &((short *)wipe_scr)[y[i] * SCREENWIDTH / 2 + i];
-
-                if (y[i] + dy >= SCREENHEIGHT)
-                    dy = SCREENHEIGHT - y[i];
-                for (j = dy; j; j--)
-                {
-                    d[idx] = *s++;
-                    idx += SCREENWIDTH / 2;
-                }
-                y[i] += dy;
-                s = &((short *)wipe_scr_start)[i * SCREENHEIGHT];
-                d = &((short *)wipe_scr)[y[i] * SCREENWIDTH / 2 + i];
-                idx = 0;
-                for (j = SCREENHEIGHT - y[i]; j; j--)
-                {
-                    d[idx] = *s++;
-                    idx += SCREENWIDTH / 2;
-                }
+                int     dy = (y[i] < 16 ? y[i] + 1 : speed);
+
+                y[i] = MIN(y[i] + dy, SCREENHEIGHT);
                 done = false;
             }
         }
+
+    // join neighbouring bands that moved the same into runs
+    for (i = 0; i < MELTBANDS; i++)
+    {
+        meltrun_t       *run = (numruns ? &meltruns[numruns - 1] : NULL);
+
+        if (top[i] >= y[i])
+            continue;
+
+        if (run && run->x + run->width == i * MELTBANDWIDTH && run->top == top[i] && run->y == y[i])
+            run->width += MELTBANDWIDTH;
+        else
+        {
+            run = &meltruns[numruns++];
+            run->x = i * MELTBANDWIDTH;
+            run->width = MELTBANDWIDTH;
+            run->top = top[i];
+            run->y = y[i];
+        }
     }
 
+    if (numruns)
+        meltrows(meltruns, numruns);
+
     return done;
 }
 
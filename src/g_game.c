@@ -60,6 +60,7 @@
 #include "m_misc.h"
 #include "m_random.h"
 #include "p_local.h"
+#include "p_prefetch.h"
 #include "p_saveg.h"
 #include "p_setup.h"
 #include "p_tick.h"
@@ -83,6 +84,12 @@ void G_DoVictory(void);
 void G_DoWorldDone(void);
 void G_DoSaveGame(void);
 
+static boolean G_DemoTicSkipped(void);
+static void G_ReadDemoTiccmd(ticcmd_t *cmd);
+static void G_WriteDemoTiccmd(ticcmd_t *cmd);
+static void G_BeginRecording(void);
+static void G_DoPlayDemo(void);
+
 // Gamestate the last time G_Ticker was called.
 
 gamestate_t     oldgamestate;
@@ -716,6 +723,10 @@ boolean G_Responder(event_t *ev)
         return false;
     }
 
+    // don't let the player interfere with a demo being played back
+    if (demoplayback)
+        return (gamestate == GS_LEVEL && AM_Responder(ev));
+
     if (gamestate == GS_LEVEL)
     {
         if (ST_Responder(ev))
@@ -888,6 +899,9 @@ void G_Ticker(void)
             case ga_newgame:
                 G_DoNewGame();
                 break;
+            case ga_playdemo:
+                G_DoPlayDemo();
+                break;
             case ga_loadgame:
                 G_DoLoadGame();
                 break;
@@ -939,6 +953,9 @@ void G_Ticker(void)
     cmd = &players[0].cmd;
     memcpy(cmd, &netcmds[(gametic / ticdup) % BACKUPTICS], sizeof(ticcmd_t));
 
+    if (demoplayback && !G_DemoTicSkipped())
+        G_ReadDemoTiccmd(cmd);
+
     // check for special buttons
     if (players[0].cmd.buttons & BT_SPECIAL)
     {
@@ -958,7 +975,7 @@ void G_Ticker(void)
                     }
 
                     players[0].fixedcolormap = 0;
-                    I_SetPalette(W_CacheLumpName("PLAYPAL", PU_CACHE));
+                    I_SetPlayPalette(0);
                 }
                 else
                 {
@@ -971,7 +988,7 @@ void G_Ticker(void)
                         XInputVibration(idlemotorspeed);
                     }
 
-                    I_SetPalette((byte *)W_CacheLumpName("PLAYPAL", PU_CACHE) + st_palette * 768);
+                    I_SetPlayPalette(st_palette);
                 }
                 break;
 
@@ -982,6 +999,9 @@ void G_Ticker(void)
         }
     }
 
+    if (demorecording && !G_DemoTicSkipped())
+        G_WriteDemoTiccmd(cmd);
+
     // Have we just finished displaying an intermission screen?
     if (oldgamestate == GS_INTERMISSION && gamestate != GS_INTERMISSION)
         WI_End();
@@ -1169,7 +1189,7 @@ boolean G_CheckSpot(int playernum, mapthing_t *mthing)
 //
 void G_DoReborn(void)
 {
-    gameaction = (quickSaveSlot < 0 ? ga_loadlevel : ga_reloadgame);
+    gameaction = (quickSaveSlot < 0 || demorecording || demoplayback ? ga_loadlevel : ga_reloadgame);
 }
 
 void G_ScreenShot(void)
@@ -1395,6 +1415,9 @@ void G_DoCompleted(void)
     viewactive = false;
     automapactive = false;
 
+    // read the next level from disk while the intermission is shown
+    P_StartPrefetch(gameepisode, wminfo.next + 1);
+
     WI_Start(&wminfo);
 }
 
@@ -1466,6 +1489,10 @@ void G_DoLoadGame(void)
 
     gameaction = ga_nothing;
 
+    // a demo can't continue from a loaded game
+    if (demorecording || demoplayback)
+        G_CheckDemoStatus();
+
     save_stream = fopen(savename, "rb");
 
     if (save_stream == NULL)
@@ -1733,4 +1760,366 @@ void G_InitNew(skill_t skill, int episode, int map)
     gameskill = skill;
 
     G_DoLoadLevel();
+
+    if (demorecording)
+        G_BeginRecording();
+}
+
+//
+// DEMO RECORDING
+//
+#define DEMOMARKER      0x80
+#define DEMOVERSION     2
+#define DEMOHEADERSIZE  14
+#define DEMOTICSIZE     5
+
+#define DEMO_NOMONSTERS 1
+#define DEMO_FAST       2
+
+extern boolean  animatedliquid;
+extern boolean  centerweapon;
+extern boolean  floatbob;
+extern boolean  footclip;
+extern boolean  mapfixes;
+extern boolean  mirrorweapons;
+extern int      playerbob;
+extern boolean  smoketrails;
+
+// Options that change how a level plays, and so are recorded in a demo and
+//  used while it's played back. Some of them also take numbers from
+//  P_Random(), so a demo would go out of sync without them.
+typedef struct
+{
+    boolean     animatedliquid;
+    boolean     centerweapon;
+    boolean     corpses_mirror;
+    boolean     corpses_moreblood;
+    boolean     corpses_slide;
+    boolean     corpses_smearblood;
+    boolean     floatbob;
+    boolean     footclip;
+    boolean     mapfixes;
+    boolean     mirrorweapons;
+    boolean     smoketrails;
+    int         maxbloodsplats;
+    int         playerbob;
+} demooptions_t;
+
+static demooptions_t    demooptions;    // the player's own while a demo is played back
+
+static char     *demoname;
+static FILE     *demo_stream;
+static byte     *demobuffer;
+static byte     *demo_p;
+static byte     *demoend;
+static boolean  singledemo;             // quit after playing a demo from command-line
+static int      demostarttic;
+static uint64_t demostarttime;
+
+boolean         demorecording;
+boolean         demoplayback;
+boolean         timingdemo;             // run the demo as fast as possible
+boolean         fastdemo;               // and don't draw it
+int             demoframes;             // frames drawn while timing a demo
+
+// A tic only advances the level if nothing is pausing it, so only those
+// are recorded, and only those are played back.
+static boolean G_DemoTicSkipped(void)
+{
+    return (gamestate == GS_LEVEL && (paused || menuactive || consoleactive));
+}
+
+static void G_ReadDemoTiccmd(ticcmd_t *cmd)
+{
+    if (demo_p + DEMOTICSIZE > demoend || *demo_p == DEMOMARKER)
+    {
+        // end of demo data stream
+        G_CheckDemoStatus();
+        return;
+    }
+
+    cmd->forwardmove = (signed char)*demo_p++;
+    cmd->sidemove = (signed char)*demo_p++;
+    cmd->angleturn = (short)(demo_p[0] | (demo_p[1] << 8));
+    demo_p += 2;
+    cmd->buttons = *demo_p++;
+}
+
+static void G_WriteDemoTiccmd(ticcmd_t *cmd)
+{
+    byte        buffer[DEMOTICSIZE];
+
+    buffer[0] = (byte)cmd->forwardmove;
+    buffer[1] = (byte)cmd->sidemove;
+    buffer[2] = (byte)(cmd->angleturn & 0xff);
+    buffer[3] = (byte)((cmd->angleturn >> 8) & 0xff);
+
+    // pausing and saving aren't played back
+    buffer[4] = ((cmd->buttons & BT_SPECIAL) ? 0 : cmd->buttons);
+
+    fwrite(buffer, 1, DEMOTICSIZE, demo_stream);
+}
+
+//
+// G_RecordDemo
+// The demo is written from the start of the next new game.
+//
+void G_RecordDemo(char *name)
+{
+    free(demoname);
+    demoname = (M_StringEndsWith(name, ".lmp") ? strdup(name) : M_StringJoin(name, ".lmp", NULL));
+
+    demorecording = true;
+}
+
+static void G_GetDemoOptions(demooptions_t *options)
+{
+    options->animatedliquid = animatedliquid;
+    options->centerweapon = centerweapon;
+    options->corpses_mirror = corpses_mirror;
+    options->corpses_moreblood = corpses_moreblood;
+    options->corpses_slide = corpses_slide;
+    options->corpses_smearblood = corpses_smearblood;
+    options->floatbob = floatbob;
+    options->footclip = footclip;
+    options->mapfixes = mapfixes;
+    options->mirrorweapons = mirrorweapons;
+    options->smoketrails = smoketrails;
+    options->maxbloodsplats = maxbloodsplats;
+    options->playerbob = playerbob;
+}
+
+static void G_SetDemoOptions(demooptions_t *options)
+{
+    animatedliquid = options->animatedliquid;
+    centerweapon = options->centerweapon;
+    corpses_mirror = options->corpses_mirror;
+    corpses_moreblood = options->corpses_moreblood;
+    corpses_slide = options->corpses_slide;
+    corpses_smearblood = options->corpses_smearblood;
+    floatbob = options->floatbob;
+    footclip = options->footclip;
+    mapfixes = options->mapfixes;
+    mirrorweapons = options->mirrorweapons;
+    smoketrails = options->smoketrails;
+    maxbloodsplats = options->maxbloodsplats;
+    playerbob = options->playerbob;
+}
+
+//
+// G_SwapDemoOptions
+// Swaps the options of the demo being played back with the player's own, so
+//  the player's can be saved, or put back once it ends.
+//
+void G_SwapDemoOptions(void)
+{
+    demooptions_t       options;
+
+    G_GetDemoOptions(&options);
+    G_SetDemoOptions(&demooptions);
+    demooptions = options;
+}
+
+static void G_WriteDemoOptions(byte *header)
+{
+    header[9] = (animatedliquid ? 1 : 0) | (centerweapon ? 2 : 0) | (corpses_mirror ? 4 : 0)
+        | (corpses_moreblood ? 8 : 0) | (corpses_slide ? 16 : 0) | (corpses_smearblood ? 32 : 0)
+        | (floatbob ? 64 : 0) | (footclip ? 128 : 0);
+    header[10] = (mapfixes ? 1 : 0) | (mirrorweapons ? 2 : 0) | (smoketrails ? 4 : 0);
+    header[11] = (byte)playerbob;
+    header[12] = (byte)(maxbloodsplats & 0xff);
+    header[13] = (byte)((maxbloodsplats >> 8) & 0xff);
+}
+
+static void G_ReadDemoOptions(byte *header, demooptions_t *options)
+{
+    options->animatedliquid = !!(header[9] & 1);
+    options->centerweapon = !!(header[9] & 2);
+    options->corpses_mirror = !!(header[9] & 4);
+    options->corpses_moreblood = !!(header[9] & 8);
+    options->corpses_slide = !!(header[9] & 16);
+    options->corpses_smearblood = !!(header[9] & 32);
+    options->floatbob = !!(header[9] & 64);
+    options->footclip = !!(header[9] & 128);
+    options->mapfixes = !!(header[10] & 1);
+    options->mirrorweapons = !!(header[10] & 2);
+    options->smoketrails = !!(header[10] & 4);
+    options->playerbob = MIN(header[11], PLAYERBOB_MAX);
+    options->maxbloodsplats = MIN(header[12] | (header[13] << 8), MAXBLOODSPLATS_MAX);
+}
+
+static void G_BeginRecording(void)
+{
+    byte        header[DEMOHEADERSIZE];
+
+    if (demo_stream)
+        fclose(demo_stream);
+
+    if (!(demo_stream = fopen(demoname, "wb")))
+    {
+        C_Warning("%s couldn't be recorded.", uppercase(demoname));
+        demorecording = false;
+        return;
+    }
+
+    header[0] = 'D';
+    header[1] = 'R';
+    header[2] = 'D';
+    header[3] = 'M';
+    header[4] = DEMOVERSION;
+    header[5] = (byte)gameskill;
+    header[6] = (byte)gameepisode;
+    header[7] = (byte)gamemap;
+    header[8] = (nomonsters ? DEMO_NOMONSTERS : 0) | (fastparm ? DEMO_FAST : 0);
+    G_WriteDemoOptions(header);
+    fwrite(header, 1, sizeof(header), demo_stream);
+
+    C_Output("Recording %s...", uppercase(demoname));
+}
+
+//
+// G_DeferredPlayDemo
+//
+void G_DeferredPlayDemo(char *name)
+{
+    free(demoname);
+    demoname = (M_FileExists(name) || M_StringEndsWith(name, ".lmp") ? strdup(name) :
+        M_StringJoin(name, ".lmp", NULL));
+
+    singledemo = true;
+    gameaction = ga_playdemo;
+}
+
+//
+// G_TimeDemo
+// Plays a demo back one tic per frame, as fast as possible, and reports
+// how long it took. If nodraw is set, the frames aren't drawn at all.
+//
+void G_TimeDemo(char *name, boolean nodraw)
+{
+    timingdemo = true;
+    fastdemo = nodraw;
+    G_DeferredPlayDemo(name);
+}
+
+//
+// G_DemoFailed
+// A demo that's being timed is there to be benchmarked, so quit rather than
+// sit at a title screen that was never started. Otherwise start it.
+//
+static void G_DemoFailed(char *reason)
+{
+    if (timingdemo)
+        I_Error("%s %s", uppercase(demoname), reason);
+
+    C_Warning("%s %s", uppercase(demoname), reason);
+    D_StartTitle((boolean)M_CheckParm("-nosplash"));
+}
+
+static void G_DoPlayDemo(void)
+{
+    int         length;
+
+    gameaction = ga_nothing;
+
+    if (!M_FileExists(demoname))
+    {
+        G_DemoFailed("couldn't be found.");
+        return;
+    }
+
+    length = M_ReadFile(demoname, &demobuffer);
+
+    if (length < DEMOHEADERSIZE || memcmp(demobuffer, "DRDM", 4) || demobuffer[4] != DEMOVERSION)
+    {
+        Z_Free(demobuffer);
+        demobuffer = NULL;
+        G_DemoFailed("isn't a valid demo.");
+        return;
+    }
+
+    nomonsters = !!(demobuffer[8] & DEMO_NOMONSTERS);
+    fastparm = !!(demobuffer[8] & DEMO_FAST);
+
+    // play the demo back with the options it was recorded with, keeping the
+    //  player's own to put back afterwards
+    G_ReadDemoOptions(demobuffer, &demooptions);
+    G_SwapDemoOptions();
+
+    if (widescreen)
+        ToggleWidescreen(true);
+
+    st_facecount = ST_STRAIGHTFACECOUNT;
+    G_InitNew((skill_t)demobuffer[5], demobuffer[6], demobuffer[7]);
+    markpointnum = 0;
+    infight = false;
+
+    usergame = false;
+    demoplayback = true;
+    demo_p = demobuffer + DEMOHEADERSIZE;
+    demoend = demobuffer + length;
+
+    C_Output("Playing %s...", uppercase(demoname));
+
+    demostarttic = gametic;
+    demoframes = 0;
+    demostarttime = I_GetTimeUS();
+}
+
+//
+// G_CheckDemoStatus
+// Called when a demo being played back runs out of tics, or when quitting
+// while a demo is being recorded.
+//
+void G_CheckDemoStatus(void)
+{
+    if (demoplayback)
+    {
+        G_SwapDemoOptions();
+        demoplayback = false;
+        Z_Free(demobuffer);
+        demobuffer = NULL;
+
+        if (timingdemo)
+        {
+            int         tics = gametic - demostarttic;
+            double      ms = (double)(I_GetTimeUS() - demostarttime) / 1000.0;
+            char        results[256];
+
+            if (fastdemo)
+                M_snprintf(results, sizeof(results),
+                    "Timed %s tics of %s in %.3f seconds: %.3f ms per tic.",
+                    commify(tics), uppercase(demoname), ms / 1000.0, ms / MAX(1, tics));
+            else
+                M_snprintf(results, sizeof(results),
+                    "Timed %s tics and %s frames of %s in %.3f seconds: %.3f ms per frame "
+                    "(%.1f fps).", commify(tics), commify(demoframes), uppercase(demoname),
+                    ms / 1000.0, ms / MAX(1, demoframes), demoframes * 1000.0 / MAX(1, (int)ms));
+
+            C_Output(results);
+            fprintf(stdout, "%s\n", results);
+            fflush(stdout);
+
+            timingdemo = false;
+            fastdemo = false;
+            I_Quit(true);
+        }
+
+        C_Output("%s has finished playing.", uppercase(demoname));
+        D_StartTitle(1);
+        return;
+    }
+
+    if (demorecording)
+    {
+        demorecording = false;
+
+        if (demo_stream)
+        {
+            fputc(DEMOMARKER, demo_stream);
+            fclose(demo_stream);
+            demo_stream = NULL;
+            C_Output("%s has been recorded.", uppercase(demoname));
+        }
+    }
 }
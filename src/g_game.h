@@ -76,6 +76,13 @@ void G_Ticker(void);
 boolean G_Responder(event_t *ev);
 
 void G_ScreenShot(void);
+
+void G_RecordDemo(char *name);
+void G_DeferredPlayDemo(char *name);
+void G_TimeDemo(char *name, boolean nodraw);
+void G_CheckDemoStatus(void);
+void G_SwapDemoOptions(void);
+
 void ToggleWidescreen(boolean toggle);
 
 extern boolean  canmodify;
@@ -93,5 +100,10 @@ extern int      quickSaveSlot;
 extern int      st_facecount;
 extern boolean  oldweaponsowned[NUMWEAPONS];
 extern boolean  blurred;
+extern boolean  demorecording;
+extern boolean  demoplayback;
+extern boolean  timingdemo;
+extern boolean  fastdemo;
+extern int      demoframes;
 
 #endif
@@ -0,0 +1,435 @@
+/*
+========================================================================
+
+                               DOOM RETRO
+         The classic, refined DOOM source port. For Windows PC.
+
+========================================================================
+
+  Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+  Copyright (C) 2013-2015 Brad Harding.
+
+  DOOM RETRO is a fork of CHOCOLATE DOOM by Simon Howard.
+  For a complete list of credits, see the accompanying AUTHORS file.
+
+  This file is part of DOOM RETRO.
+
+  DOOM RETRO is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  DOOM RETRO is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with DOOM RETRO. If not, see <http://www.gnu.org/licenses/>.
+
+  DOOM is a registered trademark of id Software LLC, a ZeniMax Media
+  company, in the US and/or other countries and is used without
+  permission. All other trademarks are the property of their respective
+  holders. DOOM RETRO is in no way affiliated with nor endorsed by
+  id Software LLC.
+
+========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "c_console.h"
+#include "doomstat.h"
+#include "g_game.h"
+#include "i_capture.h"
+#include "i_thread.h"
+#include "i_video.h"
+#include "m_fixed.h"
+#include "m_misc.h"
+#include "v_video.h"
+#include "z_zone.h"
+
+#if !defined(MAX_PATH)
+#define MAX_PATH        260
+#endif
+
+//
+// Screenshots and the frames of a capture are copied into a ring of
+// CAPTUREFRAMES slots, and a capture thread encodes and writes them out, so
+// the game never waits on the disk. When the ring is full a frame of a
+// capture is dropped, and the capture thread repeats the frame before it in
+// its place, so the video still has one frame for every tic.
+//
+typedef enum
+{
+    CAPTURE_SCREENSHOT,
+    CAPTURE_FRAME,
+    CAPTURE_END,
+    CAPTURE_QUIT
+} capturejob_t;
+
+typedef struct
+{
+    capturejob_t        job;
+    byte                *pixels;
+    SDL_Surface         *surface;       // a screenshot read back from the window
+    SDL_Color           palette[256];
+    int                 height;
+    int                 repeats;        // times to write the frame before this one first
+    FILE                *file;
+    char                path[MAX_PATH];
+} captureslot_t;
+
+boolean                 capturing;
+
+static captureslot_t    captureslots[CAPTUREFRAMES];
+static int              capturehead;    // next slot to fill
+static int              capturetail;    // next slot to write
+static SDL_Thread       *capturethread;
+static SDL_sem          *capturefree;
+static SDL_sem          *capturequeued;
+static SDL_mutex        *capturelock;
+static char             capturefailed[MAX_PATH];
+
+static FILE             *capturefile;
+static char             *capturename;
+static int              capturetic;
+static boolean          captureframes;  // a frame of the capture has been queued
+static byte             *captureframe;  // the last frame of the capture written
+
+extern SDL_Color        *palette;
+extern boolean          widescreen;
+
+static void I_CaptureFailed(char *path)
+{
+    I_LockMutex(capturelock);
+    M_StringCopy(capturefailed, path, sizeof(capturefailed));
+    I_UnlockMutex(capturelock);
+}
+
+//
+// I_SaveScreenShot
+// Saves a slot as a BMP. A copy of the window is saved as it is, and
+// otherwise the screen is saved as an 8-bit BMP, stretched to the 4:3 aspect
+// ratio it's displayed at.
+//
+static void I_SaveScreenShot(captureslot_t *slot)
+{
+    int         height = slot->height * 6 / 5;
+    SDL_Surface *surface;
+    int         y;
+
+    if (slot->surface)
+    {
+        void    *pixels = slot->surface->pixels;
+
+        if (SDL_SaveBMP(slot->surface, slot->path))
+            I_CaptureFailed(slot->path);
+
+        SDL_FreeSurface(slot->surface);
+        free(pixels);
+        slot->surface = NULL;
+        return;
+    }
+
+    surface = SDL_CreateRGBSurface(0, SCREENWIDTH, height, 8, 0, 0, 0, 0);
+    if (!surface)
+    {
+        I_CaptureFailed(slot->path);
+        return;
+    }
+
+#if defined(SDL20)
+    SDL_SetPaletteColors(surface->format->palette, slot->palette, 0, 256);
+#else
+    SDL_SetColors(surface, slot->palette, 0, 256);
+#endif
+
+    for (y = 0; y < height; y++)
+        memcpy((byte *)surface->pixels + y * surface->pitch,
+            slot->pixels + y * slot->height / height * SCREENWIDTH, SCREENWIDTH);
+
+    if (SDL_SaveBMP(surface, slot->path))
+        I_CaptureFailed(slot->path);
+
+    SDL_FreeSurface(surface);
+}
+
+//
+// I_WriteFrame
+// Converts a slot to the YUV 4:2:0 of a Y4M frame and writes it, after first
+// writing the frame before it again for any tics that were dropped.
+//
+static void I_WriteFrame(captureslot_t *slot)
+{
+    const int   size = SCREENWIDTH * SCREENHEIGHT * 3 / 2;
+    byte        luma[256];
+    byte        cb[256];
+    byte        cr[256];
+    byte        *dest;
+    byte        *src = slot->pixels;
+    int         i;
+    int         x, y;
+
+    if (!captureframe)
+    {
+        I_CaptureFailed(slot->path);
+        return;
+    }
+
+    while (slot->repeats-- > 0)
+        if (fputs("FRAME\n", slot->file) == EOF
+            || fwrite(captureframe, 1, size, slot->file) != (size_t)size)
+        {
+            I_CaptureFailed(slot->path);
+            return;
+        }
+
+    // full range BT.601, as C420jpeg expects
+    for (i = 0; i < 256; ++i)
+    {
+        int     r = slot->palette[i].r;
+        int     g = slot->palette[i].g;
+        int     b = slot->palette[i].b;
+
+        luma[i] = (77 * r + 150 * g + 29 * b + 128) >> 8;
+        cb[i] = MIN(255, (-43 * r - 85 * g + 128 * b + 32896) >> 8);
+        cr[i] = MIN(255, (128 * r - 107 * g - 21 * b + 32896) >> 8);
+    }
+
+    dest = captureframe;
+    for (i = 0; i < SCREENWIDTH * SCREENHEIGHT; ++i)
+        *dest++ = luma[src[i]];
+
+    for (y = 0; y < SCREENHEIGHT; y += 2)
+    {
+        byte    *row1 = src + y * SCREENWIDTH;
+        byte    *row2 = row1 + SCREENWIDTH;
+        byte    *u = captureframe + SCREENWIDTH * SCREENHEIGHT + y / 2 * SCREENWIDTH / 2;
+        byte    *v = u + SCREENWIDTH * SCREENHEIGHT / 4;
+
+        for (x = 0; x < SCREENWIDTH; x += 2)
+        {
+            *u++ = (cb[row1[x]] + cb[row1[x + 1]] + cb[row2[x]] + cb[row2[x + 1]] + 2) >> 2;
+            *v++ = (cr[row1[x]] + cr[row1[x + 1]] + cr[row2[x]] + cr[row2[x + 1]] + 2) >> 2;
+        }
+    }
+
+    if (fputs("FRAME\n", slot->file) == EOF
+        || fwrite(captureframe, 1, size, slot->file) != (size_t)size)
+        I_CaptureFailed(slot->path);
+}
+
+static int I_CaptureThread(void *data)
+{
+    captureframe = malloc(SCREENWIDTH * SCREENHEIGHT * 3 / 2);
+
+    while (1)
+    {
+        captureslot_t   *slot;
+
+        I_SemWait(capturequeued);
+        slot = &captureslots[capturetail];
+        capturetail = (capturetail + 1) % CAPTUREFRAMES;
+
+        switch (slot->job)
+        {
+            case CAPTURE_SCREENSHOT:
+                I_SaveScreenShot(slot);
+                break;
+
+            case CAPTURE_FRAME:
+                I_WriteFrame(slot);
+                break;
+
+            case CAPTURE_END:
+                fclose(slot->file);
+                break;
+
+            case CAPTURE_QUIT:
+                free(captureframe);
+                I_SemPost(capturefree);
+                return 0;
+        }
+
+        I_SemPost(capturefree);
+    }
+}
+
+//
+// I_GetCaptureSlot
+// Returns the next free slot in the ring, starting the capture thread if it
+// isn't running yet. Returns NULL if wait is false and the ring is full.
+//
+static captureslot_t *I_GetCaptureSlot(boolean wait)
+{
+    if (!capturethread)
+    {
+        int     i;
+
+        for (i = 0; i < CAPTUREFRAMES; ++i)
+            if (!captureslots[i].pixels)
+                captureslots[i].pixels = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
+
+        if (!capturefree)
+        {
+            capturefree = I_CreateSemaphore(CAPTUREFRAMES);
+            capturequeued = I_CreateSemaphore(0);
+            capturelock = I_CreateMutex();
+        }
+
+        capturethread = I_CreateThread(I_CaptureThread, "capture", NULL);
+    }
+
+    if (wait)
+        I_SemWait(capturefree);
+    else if (!I_SemTryWait(capturefree))
+        return NULL;
+
+    return &captureslots[capturehead];
+}
+
+static void I_QueueCaptureSlot(captureslot_t *slot, capturejob_t job, int height)
+{
+    slot->job = job;
+    slot->height = height;
+
+    if (height)
+    {
+        memcpy(slot->pixels, screens[0], SCREENWIDTH * height);
+        memcpy(slot->palette, palette, sizeof(slot->palette));
+    }
+
+    capturehead = (capturehead + 1) % CAPTUREFRAMES;
+    I_SemPost(capturequeued);
+}
+
+//
+// I_QueueScreenShot
+//
+boolean I_QueueScreenShot(char *path, SDL_Surface *surface)
+{
+    captureslot_t       *slot;
+    FILE                *file = fopen(path, "wb");
+
+    // create the file now, so the name is taken before it's written
+    if (!file)
+    {
+        if (surface)
+        {
+            free(surface->pixels);
+            SDL_FreeSurface(surface);
+        }
+        return false;
+    }
+    fclose(file);
+
+    slot = I_GetCaptureSlot(true);
+    M_StringCopy(slot->path, path, sizeof(slot->path));
+    slot->surface = surface;
+    I_QueueCaptureSlot(slot, CAPTURE_SCREENSHOT,
+        (surface ? 0 : SCREENHEIGHT - SBARHEIGHT * widescreen));
+    return true;
+}
+
+//
+// I_StartCapture
+//
+boolean I_StartCapture(char *path)
+{
+    FILE        *file = fopen(path, "wb");
+
+    if (!file)
+        return false;
+
+    I_StopCapture();
+
+    // the pixels are 5:6, to be displayed at 4:3
+    fprintf(file, "YUV4MPEG2 W%i H%i F%i:1 Ip A5:6 C420jpeg\n", SCREENWIDTH, SCREENHEIGHT,
+        TICRATE);
+
+    capturefile = file;
+    free(capturename);
+    capturename = strdup(path);
+    capturetic = gametic - 1;
+    captureframes = false;
+    capturing = true;
+    return true;
+}
+
+void I_StopCapture(void)
+{
+    captureslot_t       *slot;
+
+    if (!capturing)
+        return;
+
+    slot = I_GetCaptureSlot(true);
+    slot->file = capturefile;
+    I_QueueCaptureSlot(slot, CAPTURE_END, 0);
+
+    capturefile = NULL;
+    capturing = false;
+}
+
+char *I_CaptureName(void)
+{
+    return (capturing ? capturename : NULL);
+}
+
+//
+// I_UpdateCapture
+// Queues the first frame displayed in each tic of a capture, and reports
+// anything the capture thread couldn't write.
+//
+void I_UpdateCapture(void)
+{
+    if (capturelock && *capturefailed)
+    {
+        char    failed[MAX_PATH];
+
+        I_LockMutex(capturelock);
+        M_StringCopy(failed, capturefailed, sizeof(failed));
+        *capturefailed = '\0';
+        I_UnlockMutex(capturelock);
+
+        C_Warning("%s couldn't be saved.", uppercase(failed));
+        if (capturing && !strcmp(failed, capturename))
+            I_StopCapture();
+    }
+
+    if (capturing && gametic != capturetic)
+    {
+        // a demo being timed has no real time to keep up with, so it waits
+        //  rather than dropping frames
+        captureslot_t   *slot = I_GetCaptureSlot(timingdemo);
+
+        if (slot)
+        {
+            slot->file = capturefile;
+            M_StringCopy(slot->path, capturename, sizeof(slot->path));
+            // there's no frame to repeat until the first one is written
+            slot->repeats = (captureframes ? MAX(0, gametic - capturetic - 1) : 0);
+            captureframes = true;
+            I_QueueCaptureSlot(slot, CAPTURE_FRAME, SCREENHEIGHT);
+            capturetic = gametic;
+        }
+    }
+}
+
+//
+// I_ShutdownCapture
+//
+void I_ShutdownCapture(void)
+{
+    I_StopCapture();
+
+    if (capturethread)
+    {
+        I_QueueCaptureSlot(I_GetCaptureSlot(true), CAPTURE_QUIT, 0);
+        I_WaitThread(capturethread);
+        capturethread = NULL;
+    }
+}
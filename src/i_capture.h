@@ -0,0 +1,66 @@
+/*
+========================================================================
+
+                               DOOM RETRO
+         The classic, refined DOOM source port. For Windows PC.
+
+========================================================================
+
+  Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+  Copyright (C) 2013-2015 Brad Harding.
+
+  DOOM RETRO is a fork of CHOCOLATE DOOM by Simon Howard.
+  For a complete list of credits, see the accompanying AUTHORS file.
+
+  This file is part of DOOM RETRO.
+
+  DOOM RETRO is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  DOOM RETRO is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with DOOM RETRO. If not, see <http://www.gnu.org/licenses/>.
+
+  DOOM is a registered trademark of id Software LLC, a ZeniMax Media
+  company, in the US and/or other countries and is used without
+  permission. All other trademarks are the property of their respective
+  holders. DOOM RETRO is in no way affiliated with nor endorsed by
+  id Software LLC.
+
+========================================================================
+*/
+
+#if !defined(__I_CAPTURE__)
+#define __I_CAPTURE__
+
+#include "doomtype.h"
+#include "SDL.h"
+
+// Frames that can be waiting to be encoded and written at once.
+#define CAPTUREFRAMES   8
+
+extern boolean  capturing;
+
+// Queue a screenshot to be saved as a BMP by the capture thread. surface is a
+//  copy of the window, and is freed along with its pixels once saved. If
+//  it's NULL, the screen is copied into the ring instead.
+boolean I_QueueScreenShot(char *path, SDL_Surface *surface);
+
+// Stream every tic that is displayed to a Y4M file.
+boolean I_StartCapture(char *path);
+void I_StopCapture(void);
+char *I_CaptureName(void);
+
+// Called once a frame has been displayed.
+void I_UpdateCapture(void);
+
+// Wait for everything queued to be written.
+void I_ShutdownCapture(void);
+
+#endif
@@ -55,12 +55,19 @@ void I_ShutdownWindows32(void);
 #include <CoreFoundation/CFUserNotification.h>
 #endif
 
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <cpuid.h>
+#endif
+
 #include "c_console.h"
 #include "d_net.h"
 #include "doomdef.h"
 #include "doomstat.h"
 #include "g_game.h"
 #include "i_gamepad.h"
+#include "i_system.h"
 #include "i_timer.h"
 #include "i_video.h"
 #include "m_argv.h"
@@ -169,11 +176,78 @@ void I_PrintWindowsVersion(void)
 }
 #endif
 
+#if defined(X86_CPU)
+static void I_CPUID(int leaf, int subleaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex((int *)regs, leaf, subleaf);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Returns the state components the OS saves on a context switch.
+static unsigned int I_XGETBV(void)
+{
+#if defined(_MSC_VER)
+    return (unsigned int)_xgetbv(0);
+#else
+    unsigned int        eax, edx;
+
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return eax;
+#endif
+}
+#endif
+
+//
+// I_GetCPUFeatures
+// Uses cpuid to find which instruction set extensions can be used for
+// the renderer's drawing functions.
+//
+int I_GetCPUFeatures(void)
+{
+    static int  features = -1;
+
+    if (features == -1)
+    {
+#if defined(X86_CPU)
+        unsigned int    regs[4];
+
+        features = 0;
+        I_CPUID(0, 0, regs);
+        if (regs[0] >= 1)
+        {
+            unsigned int        maxleaf = regs[0];
+
+            I_CPUID(1, 0, regs);
+            if (regs[3] & (1 << 26))
+                features |= CPU_SSE2;
+
+            // AVX2 also needs the OS to save the upper halves of the ymm registers
+            if (maxleaf >= 7 && (regs[2] & (1 << 27)) && (regs[2] & (1 << 28))
+                && (I_XGETBV() & 6) == 6)
+            {
+                I_CPUID(7, 0, regs);
+                if (regs[1] & (1 << 5))
+                    features |= CPU_AVX2;
+            }
+        }
+#else
+        features = 0;
+#endif
+    }
+    return features;
+}
+
 //
 // I_Quit
 //
 void I_Quit(boolean shutdown)
 {
+    if (demorecording)
+        G_CheckDemoStatus();
+
     if (shutdown)
     {
         S_Shutdown();
@@ -59,4 +59,24 @@ void I_Error(char *error, ...);
 
 void I_PrintWindowsVersion(void);
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define X86_CPU
+#endif
+
+// TARGET compiles a function for an instruction set extension that the rest
+//  of the executable doesn't assume, and ALIGN aligns a variable.
+#if defined(__GNUC__)
+#define TARGET(x)       __attribute__((target(x)))
+#define ALIGN(x)        __attribute__((aligned(x)))
+#else
+#define TARGET(x)
+#define ALIGN(x)        __declspec(align(x))
+#endif
+
+// Instruction set extensions returned by I_GetCPUFeatures.
+#define CPU_SSE2        1
+#define CPU_AVX2        2
+
+int I_GetCPUFeatures(void);
+
 #endif
@@ -0,0 +1,138 @@
+/*
+========================================================================
+
+                               DOOM RETRO
+         The classic, refined DOOM source port. For Windows PC.
+
+========================================================================
+
+  Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+  Copyright (C) 2013-2015 Brad Harding.
+
+  DOOM RETRO is a fork of CHOCOLATE DOOM by Simon Howard.
+  For a complete list of credits, see the accompanying AUTHORS file.
+
+  This file is part of DOOM RETRO.
+
+  DOOM RETRO is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  DOOM RETRO is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with DOOM RETRO. If not, see <http://www.gnu.org/licenses/>.
+
+  DOOM is a registered trademark of id Software LLC, a ZeniMax Media
+  company, in the US and/or other countries and is used without
+  permission. All other trademarks are the property of their respective
+  holders. DOOM RETRO is in no way affiliated with nor endorsed by
+  id Software LLC.
+
+========================================================================
+*/
+
+#if defined(WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "i_system.h"
+#include "i_thread.h"
+#include "i_video.h"
+#include "m_fixed.h"
+
+//
+// I_CreateThread
+//
+SDL_Thread *I_CreateThread(threadfunc_t func, char *name, void *data)
+{
+#if defined(SDL20)
+    SDL_Thread  *thread = SDL_CreateThread(func, name, data);
+#else
+    SDL_Thread  *thread = SDL_CreateThread(func, data);
+#endif
+
+    if (!thread)
+        I_Error("I_CreateThread: Unable to create %s thread", name);
+
+    return thread;
+}
+
+void I_WaitThread(SDL_Thread *thread)
+{
+    SDL_WaitThread(thread, NULL);
+}
+
+SDL_mutex *I_CreateMutex(void)
+{
+    SDL_mutex   *mutex = SDL_CreateMutex();
+
+    if (!mutex)
+        I_Error("I_CreateMutex: Unable to create mutex");
+
+    return mutex;
+}
+
+void I_LockMutex(SDL_mutex *mutex)
+{
+    SDL_LockMutex(mutex);
+}
+
+void I_UnlockMutex(SDL_mutex *mutex)
+{
+    SDL_UnlockMutex(mutex);
+}
+
+void I_DestroyMutex(SDL_mutex *mutex)
+{
+    SDL_DestroyMutex(mutex);
+}
+
+SDL_sem *I_CreateSemaphore(int value)
+{
+    SDL_sem     *sem = SDL_CreateSemaphore(value);
+
+    if (!sem)
+        I_Error("I_CreateSemaphore: Unable to create semaphore");
+
+    return sem;
+}
+
+void I_SemWait(SDL_sem *sem)
+{
+    SDL_SemWait(sem);
+}
+
+void I_SemPost(SDL_sem *sem)
+{
+    SDL_SemPost(sem);
+}
+
+boolean I_SemTryWait(SDL_sem *sem)
+{
+    return !SDL_SemTryWait(sem);
+}
+
+//
+// I_GetCPUCount
+//
+int I_GetCPUCount(void)
+{
+#if defined(SDL20)
+    return SDL_GetCPUCount();
+#elif defined(WIN32)
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return MAX(1, (int)info.dwNumberOfProcessors);
+#else
+    return MAX(1, (int)sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+}
@@ -0,0 +1,123 @@
+/*
+========================================================================
+
+                               DOOM RETRO
+         The classic, refined DOOM source port. For Windows PC.
+
+========================================================================
+
+  Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+  Copyright (C) 2013-2015 Brad Harding.
+
+  DOOM RETRO is a fork of CHOCOLATE DOOM by Simon Howard.
+  For a complete list of credits, see the accompanying AUTHORS file.
+
+  This file is part of DOOM RETRO.
+
+  DOOM RETRO is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  DOOM RETRO is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with DOOM RETRO. If not, see <http://www.gnu.org/licenses/>.
+
+  DOOM is a registered trademark of id Software LLC, a ZeniMax Media
+  company, in the US and/or other countries and is used without
+  permission. All other trademarks are the property of their respective
+  holders. DOOM RETRO is in no way affiliated with nor endorsed by
+  id Software LLC.
+
+========================================================================
+*/
+
+#if !defined(__I_THREAD__)
+#define __I_THREAD__
+
+#include "doomtype.h"
+#include "SDL.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+typedef int (*threadfunc_t)(void *);
+
+// Start a new thread running func(data).
+SDL_Thread *I_CreateThread(threadfunc_t func, char *name, void *data);
+
+// Wait for a thread to finish.
+void I_WaitThread(SDL_Thread *thread);
+
+// Recursive mutexes.
+SDL_mutex *I_CreateMutex(void);
+void I_LockMutex(SDL_mutex *mutex);
+void I_UnlockMutex(SDL_mutex *mutex);
+void I_DestroyMutex(SDL_mutex *mutex);
+
+// Counting semaphores.
+SDL_sem *I_CreateSemaphore(int value);
+void I_SemWait(SDL_sem *sem);
+void I_SemPost(SDL_sem *sem);
+
+// Returns false instead of waiting if the semaphore is zero.
+boolean I_SemTryWait(SDL_sem *sem);
+
+// Returns the number of logical CPU cores.
+int I_GetCPUCount(void);
+
+// Loads and stores of flags and pointers that other threads check without
+//  taking a lock. A thread that loads a value stored with I_StoreRelease*()
+//  also sees everything the storing thread wrote before it. MSVC gives
+//  volatile accesses these semantics on x86, so only the compiler needs
+//  holding back there.
+static __inline int I_LoadAcquireInt(const volatile int *p)
+{
+#if defined(_MSC_VER)
+    int value = *p;
+
+    _ReadWriteBarrier();
+    return value;
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static __inline void I_StoreReleaseInt(volatile int *p, int value)
+{
+#if defined(_MSC_VER)
+    _ReadWriteBarrier();
+    *p = value;
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+}
+
+static __inline void *I_LoadAcquirePtr(void *const volatile *p)
+{
+#if defined(_MSC_VER)
+    void        *value = *p;
+
+    _ReadWriteBarrier();
+    return value;
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static __inline void I_StoreReleasePtr(void *volatile *p, void *value)
+{
+#if defined(_MSC_VER)
+    _ReadWriteBarrier();
+    *p = value;
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+}
+
+#endif
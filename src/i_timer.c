@@ -69,6 +69,25 @@ int I_GetTimeMS(void)
     return (ticks - basetime);
 }
 
+//
+// Same as I_GetTimeMS, but returns time in microseconds. Only differences
+// between two calls are meaningful.
+//
+uint64_t I_GetTimeUS(void)
+{
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+    static Uint64       frequency;
+    Uint64              counter = SDL_GetPerformanceCounter();
+
+    if (!frequency)
+        frequency = SDL_GetPerformanceFrequency();
+
+    return (counter / frequency * 1000000 + counter % frequency * 1000000 / frequency);
+#else
+    return ((uint64_t)SDL_GetTicks() * 1000);
+#endif
+}
+
 //
 // Sleep for a specified number of ms
 //
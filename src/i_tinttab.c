@@ -36,9 +36,21 @@
 ========================================================================
 */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "c_console.h"
+#include "i_timer.h"
 #include "m_fixed.h"
 #include "z_zone.h"
 
+// Built tint tables are saved here, and loaded on later runs with the same
+//  palette instead of being built again.
+#define TINTTABCACHE            "tinttabs.cache"
+#define TINTTABCACHEMAGIC       "DRTT"
+#define TINTTABCACHEVERSION     1
+
 #define ADDITIVE       -1
 
 #define R               1
@@ -109,9 +121,123 @@ int FindNearestColor(byte *palette, int red, int green, int blue)
     return best_color;
 }
 
-static byte *GenerateTintTable(byte *palette, int percent, int colors)
+//
+// Fast nearest color search for building the tint tables. The palette is
+//  sorted by red, and the search works outwards from the target's red,
+//  stopping in each direction once the difference in red alone is more
+//  than that of the best color found. Ties go to the lowest index, so the
+//  result is always the same as FindNearestColor's. Results are also kept
+//  in a small cache, since the same blends come up in many tables.
+//
+#define NEARESTCACHESIZE        65536
+
+static byte     *nearestpalette;
+static byte     sortedbyred[256];
+static uint32_t nearestcachekey[NEARESTCACHESIZE];
+static byte     nearestcachecolor[NEARESTCACHESIZE];
+
+static int CompareRed(const void *a, const void *b)
+{
+    int i = *(const byte *)a;
+    int j = *(const byte *)b;
+    int red = nearestpalette[i * 3] - nearestpalette[j * 3];
+
+    return (red ? red : i - j);
+}
+
+static void InitNearestColor(byte *palette)
+{
+    int i;
+
+    nearestpalette = palette;
+
+    for (i = 0; i < 256; ++i)
+        sortedbyred[i] = i;
+    qsort(sortedbyred, 256, 1, CompareRed);
+
+    memset(nearestcachekey, 0, sizeof(nearestcachekey));
+}
+
+static int FindNearestColorFast(int red, int green, int blue)
+{
+    uint32_t    key = (1 << 24) | (red << 16) | (green << 8) | blue;
+    int         hash = (key * 2654435761u) >> 16;
+    int         best_difference = INT_MAX;
+    int         best_color = 0;
+    int         lo = 0;
+    int         hi = 256;
+
+    if (nearestcachekey[hash] == key)
+        return nearestcachecolor[hash];
+
+    // find the first color with at least as much red
+    while (lo < hi)
+    {
+        int     mid = (lo + hi) / 2;
+
+        if (nearestpalette[sortedbyred[mid] * 3] < red)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    hi = lo--;
+
+    while (lo >= 0 || hi < 256)
+    {
+        if (hi < 256)
+        {
+            int         color = sortedbyred[hi];
+            byte        *rgb = nearestpalette + color * 3;
+            int         r = rgb[0] - red;
+
+            if (r * r > best_difference)
+                hi = 256;
+            else
+            {
+                int     g = rgb[1] - green;
+                int     b = rgb[2] - blue;
+                int     difference = r * r + g * g + b * b;
+
+                if (difference < best_difference || (difference == best_difference && color < best_color))
+                {
+                    best_color = color;
+                    best_difference = difference;
+                }
+                ++hi;
+            }
+        }
+
+        if (lo >= 0)
+        {
+            int         color = sortedbyred[lo];
+            byte        *rgb = nearestpalette + color * 3;
+            int         r = rgb[0] - red;
+
+            if (r * r > best_difference)
+                lo = -1;
+            else
+            {
+                int     g = rgb[1] - green;
+                int     b = rgb[2] - blue;
+                int     difference = r * r + g * g + b * b;
+
+                if (difference < best_difference || (difference == best_difference && color < best_color))
+                {
+                    best_color = color;
+                    best_difference = difference;
+                }
+                --lo;
+            }
+        }
+    }
+
+    nearestcachekey[hash] = key;
+    nearestcachecolor[hash] = best_color;
+    return best_color;
+}
+
+static void GenerateTintTable(byte *result, byte *palette, int percent, int colors)
 {
-    byte        *result = Z_Malloc(65536, PU_STATIC, NULL);
     int         foreground, background;
 
     for (foreground = 0; foreground < 256; ++foreground)
@@ -147,7 +273,7 @@ static byte *GenerateTintTable(byte *palette, int percent, int colors)
                     g = ((int)color1[1] * percentage + (int)color2[1] * (100 - percentage)) / 100;
                     b = ((int)color1[2] * percentage + (int)color2[2] * (100 - percentage)) / 100;
                 }
-                *(result + (background << 8) + foreground) = FindNearestColor(palette, r, g, b);
+                *(result + (background << 8) + foreground) = FindNearestColorFast(r, g, b);
             }
         }
         else
@@ -161,29 +287,115 @@ static byte *GenerateTintTable(byte *palette, int percent, int colors)
         *(result + (77 << 8) + 109) = *(result + (109 << 8) + 77) = 77;
         *(result + (78 << 8) + 109) = *(result + (109 << 8) + 78) = 109;
     }
+}
+
+static struct
+{
+    byte        **table;
+    int         percent;
+    int         colors;
+} tinttabs[] =
+{
+    { &tinttab,           ADDITIVE, ALL            },
+
+    { &tinttab25,         25,       ALL            },
+    { &tinttab33,         33,       ALL            },
+    { &tinttab40,         40,       ALL            },
+    { &tinttab50,         50,       ALL            },
+    { &tinttab60,         60,       ALL            },
+    { &tinttab66,         66,       ALL            },
+    { &tinttab75,         75,       ALL            },
+    { &tinttab80,         80,       ALL            },
+
+    { &tinttabred,        ADDITIVE, REDS           },
+    { &tinttabredwhite,   ADDITIVE, REDS | WHITES  },
+    { &tinttabgreen,      ADDITIVE, GREENS         },
+    { &tinttabblue,       ADDITIVE, BLUES          },
+
+    { &tinttabred50,      50,       REDS           },
+    { &tinttabredwhite50, 50,       REDS | WHITES  },
+    { &tinttabgreen50,    50,       GREENS         },
+    { &tinttabblue50,     50,       BLUES          }
+};
+
+#define NUMTINTTABS     (sizeof(tinttabs) / sizeof(tinttabs[0]))
+
+// FNV-1a hash of the palette, to tell if the cached tables were built from it
+static uint32_t HashPalette(byte *palette)
+{
+    uint32_t    hash = 2166136261u;
+    int         i;
+
+    for (i = 0; i < 768; ++i)
+        hash = (hash ^ palette[i]) * 16777619u;
+
+    return hash;
+}
+
+static boolean LoadTintTables(byte *tables, uint32_t hash)
+{
+    FILE        *handle = fopen(TINTTABCACHE, "rb");
+    char        magic[4];
+    int         version;
+    uint32_t    cachedhash;
+    boolean     result;
+
+    if (!handle)
+        return false;
+
+    result = (fread(magic, 1, 4, handle) == 4 && !memcmp(magic, TINTTABCACHEMAGIC, 4)
+        && fread(&version, sizeof(version), 1, handle) == 1 && version == TINTTABCACHEVERSION
+        && fread(&cachedhash, sizeof(cachedhash), 1, handle) == 1 && cachedhash == hash
+        && fread(tables, 65536, NUMTINTTABS, handle) == NUMTINTTABS);
+
+    fclose(handle);
     return result;
 }
 
+static void SaveTintTables(byte *tables, uint32_t hash)
+{
+    FILE        *handle = fopen(TINTTABCACHE, "wb");
+    int         version = TINTTABCACHEVERSION;
+
+    if (!handle)
+        return;
+
+    if (fwrite(TINTTABCACHEMAGIC, 1, 4, handle) != 4
+        || fwrite(&version, sizeof(version), 1, handle) != 1
+        || fwrite(&hash, sizeof(hash), 1, handle) != 1
+        || fwrite(tables, 65536, NUMTINTTABS, handle) != NUMTINTTABS)
+    {
+        // don't leave a partial cache behind
+        fclose(handle);
+        remove(TINTTABCACHE);
+        return;
+    }
+
+    fclose(handle);
+}
+
 void I_InitTintTables(byte *palette)
 {
-    tinttab = GenerateTintTable(palette, ADDITIVE, ALL);
-
-    tinttab25 = GenerateTintTable(palette, 25, ALL);
-    tinttab33 = GenerateTintTable(palette, 33, ALL);
-    tinttab40 = GenerateTintTable(palette, 40, ALL);
-    tinttab50 = GenerateTintTable(palette, 50, ALL);
-    tinttab60 = GenerateTintTable(palette, 60, ALL);
-    tinttab66 = GenerateTintTable(palette, 66, ALL);
-    tinttab75 = GenerateTintTable(palette, 75, ALL);
-    tinttab80 = GenerateTintTable(palette, 80, ALL);
-
-    tinttabred = GenerateTintTable(palette, ADDITIVE, REDS);
-    tinttabredwhite = GenerateTintTable(palette, ADDITIVE, REDS | WHITES);
-    tinttabgreen = GenerateTintTable(palette, ADDITIVE, GREENS);
-    tinttabblue = GenerateTintTable(palette, ADDITIVE, BLUES);
-
-    tinttabred50 = GenerateTintTable(palette, 50, REDS);
-    tinttabredwhite50 = GenerateTintTable(palette, 50, REDS | WHITES);
-    tinttabgreen50 = GenerateTintTable(palette, 50, GREENS);
-    tinttabblue50 = GenerateTintTable(palette, 50, BLUES);
+    byte                *tables = Z_Malloc(NUMTINTTABS * 65536, PU_STATIC, NULL);
+    uint32_t            hash = HashPalette(palette);
+    uint64_t            start = I_GetTimeUS();
+    unsigned int        i;
+
+    if (LoadTintTables(tables, hash))
+        C_Output("Loaded the tint tables from %s in %i ms.", TINTTABCACHE,
+            (int)((I_GetTimeUS() - start) / 1000));
+    else
+    {
+        InitNearestColor(palette);
+
+        for (i = 0; i < NUMTINTTABS; ++i)
+            GenerateTintTable(tables + i * 65536, palette, tinttabs[i].percent, tinttabs[i].colors);
+
+        C_Output("Built the tint tables in %i ms.", (int)((I_GetTimeUS() - start) / 1000));
+
+        SaveTintTables(tables, hash);
+    }
+
+    for (i = 0; i < NUMTINTTABS; ++i)
+        *tinttabs[i].table = tables + i * 65536;
 }
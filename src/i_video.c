@@ -41,10 +41,13 @@
 #include "d_main.h"
 #include "doomstat.h"
 #include "hu_stuff.h"
+#include "i_capture.h"
 #include "i_gamepad.h"
 #include "i_system.h"
 #include "i_tinttab.h"
+#include "i_timer.h"
 #include "i_video.h"
+#include "m_argv.h"
 #include "m_config.h"
 #include "m_menu.h"
 #include "m_misc.h"
@@ -63,6 +66,13 @@
 #define __forceinline inline __attribute__((always_inline))
 #endif
 
+#if defined(X86_CPU)
+#include <immintrin.h>
+#endif
+
+// number of palettes in PLAYPAL
+#define NUMPLAYPALS             14
+
 // Window position:
 char                    *windowposition = WINDOWPOSITION_DEFAULT;
 
@@ -75,8 +85,15 @@ SDL_Surface             *screenbuffer = NULL;
 #if defined(SDL20)
 SDL_Window              *window = NULL;
 SDL_Renderer            *renderer;
-static SDL_Surface      *rgbbuffer = NULL;
-static SDL_Texture      *texture = NULL; 
+static SDL_Texture      *texture = NULL;
+
+// palette as pixels in the texture's format, and the function that uses it
+//  to expand screens[0] into the texture
+static Uint32           *rgbpalette;
+static Uint32           rgbplaypals[NUMPLAYPALS][256];
+static Uint32           rgbcustompal[256];
+static void             (*expandpalette)(const byte *, Uint32 *, int);
+
 
 int                     display = DISPLAY_DEFAULT;
 int                     numdisplays;
@@ -86,10 +103,23 @@ char                    *scalefilter = SCALEFILTER_DEFAULT;
 boolean                 vsync = VSYNC_DEFAULT;
 #endif
 
-// palette
-SDL_Color               palette[256];
+// palette, which points to one of the PLAYPAL palettes precomputed for the
+//  current gamma correction level, or to the one last set with I_SetPalette
+static SDL_Color        playpals[NUMPLAYPALS][256];
+static SDL_Color        custompal[256];
+SDL_Color               *palette = custompal;
+static int              numplaypals;
+static int              playpalindex = -1;
+static int              playpalgamma = -1;
 static boolean          palette_to_set;
 
+// Headless mode (-headless), where there's no window and nothing is
+//  presented, and the hashes of the frames (-framehashes)
+boolean                 headless;
+static FILE             *framehashfile;
+static uint64_t         framehash;
+static int              framehashes;
+
 // Bit mask of mouse button state
 static unsigned int     mouse_button_state = 0;
 
@@ -135,6 +165,10 @@ boolean                 capfps = CAPFPS_DEFAULT;
 // when the screen isn't visible, don't render the screen
 boolean                 screenvisible;
 
+// When the last frame was finished, just before waiting to present it, so
+//  r_targetfps can tell how long frames take to render
+uint64_t                framefinished;
+
 boolean                 window_focused;
 
 // Empty mouse cursor
@@ -164,6 +198,15 @@ static int              blitheight = SCREENHEIGHT << FRACBITS;
 
 static int              pitch;
 byte                    *pixels;
+
+// Source column of each pixel across and source row of each row down the
+//  stretched screen, worked out whenever the video mode changes
+static int              *blitcolumns;
+static int              *blitrows;
+static int              blitwidth;
+static int              blitgatherwidth;
+static int              blitrowcount;
+static void             (*stretchrow)(const byte *, byte *);
 #endif
 
 byte                    *rows[SCREENHEIGHT];
@@ -191,10 +234,7 @@ float                   gammalevel = GAMMALEVEL_DEFAULT;
 
 SDL_Rect                src_rect = { 0, 0, 0, 0 };
 
-#if defined(SDL20)
-SDL_Rect                screenbuffer_rect;
-SDL_Rect                rgbbuffer_rect;
-#else
+#if !defined(SDL20)
 SDL_Rect                dest_rect = { 0, 0, 0, 0 };
 #endif
 
@@ -501,7 +541,6 @@ static void FreeSurfaces(void)
     SDL_FreeSurface(screenbuffer);
 
 #if defined(SDL20)
-    SDL_FreeSurface(rgbbuffer);
     SDL_DestroyTexture(texture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -510,6 +549,25 @@ static void FreeSurfaces(void)
 
 void I_ShutdownGraphics(void)
 {
+    I_ShutdownCapture();
+
+    if (framehashfile)
+    {
+        char    results[128];
+
+        M_snprintf(results, sizeof(results), "Hash of %s frames is %016llx.", commify(framehashes),
+            (unsigned long long)framehash);
+        C_Output(results);
+        fprintf(stdout, "%s\n", results);
+        fflush(stdout);
+
+        fclose(framehashfile);
+        framehashfile = NULL;
+    }
+
+    if (headless)
+        return;
+
     SetShowCursor(true);
     FreeSurfaces();
     SDL_QuitSubSystem(SDL_INIT_VIDEO);
@@ -821,67 +879,427 @@ static void UpdateGrab(void)
 }
 
 #if !defined(SDL20)
-static __forceinline void StretchBlit(void)
+//
+// StretchRow
+// Stretches a row of screens[0] across a row of screenbuffer.
+//
+static void StretchRow(const byte *src, byte *dest)
 {
-    fixed_t     i = 0;
-    fixed_t     y = starty;
+    int i;
 
-    do
-    {
-        byte    *dest = pixels + i;
-        byte    *src = *(rows + (y >> FRACBITS));
-        fixed_t x = startx;
+    for (i = 0; i < blitwidth; ++i)
+        dest[i] = src[blitcolumns[i]];
+}
 
-        do
-            *dest++ = *(src + (x >> FRACBITS));
-        while ((x += stepx) < (SCREENWIDTH << FRACBITS));
+#if defined(X86_CPU)
+//
+// StretchRowAVX2
+// Same as StretchRow, but gathers 16 pixels at a time. A gather fetches 4
+//  bytes, so the last few pixels, which may be near the end of the source
+//  row, are still done one at a time.
+//
+TARGET("avx2") static void StretchRowAVX2(const byte *src, byte *dest)
+{
+    const __m256i       mask = _mm256_set1_epi32(0xff);
+    int                 i;
+
+    for (i = 0; i < blitgatherwidth; i += 16)
+    {
+        __m256i a = _mm256_and_si256(_mm256_i32gather_epi32((const int *)src,
+                        _mm256_loadu_si256((const __m256i *)&blitcolumns[i]), 1), mask);
+        __m256i b = _mm256_and_si256(_mm256_i32gather_epi32((const int *)src,
+                        _mm256_loadu_si256((const __m256i *)&blitcolumns[i + 8]), 1), mask);
+        __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xd8);
+
+        _mm_storeu_si128((__m128i *)(dest + i), _mm_packus_epi16(_mm256_castsi256_si128(words),
+            _mm256_extracti128_si256(words, 1)));
+    }
 
-        i += pitch;
-    } while ((y += stepy) < blitheight);
+    for (; i < blitwidth; ++i)
+        dest[i] = src[blitcolumns[i]];
 }
 #endif
 
 //
-// I_FinishUpdate
+// SetupStretchBlit
+// Works out which pixel of screens[0] ends up at each column and row of
+//  a w by h screenbuffer, so StretchBlit doesn't have to step through
+//  screens[0] in fixed point for every pixel of every frame.
 //
-void I_FinishUpdate(void)
+static void SetupStretchBlit(int w, int h)
 {
-    static int  tic = 0;
+    fixed_t     x, y;
+    int         i;
 
-    if (!capfps || tic != gametic || wipe)
+    pitch = screenbuffer->pitch;
+    pixels = (byte *)screenbuffer->pixels;
+
+    stepx = (SCREENWIDTH << FRACBITS) / w;
+    stepy = (SCREENHEIGHT << FRACBITS) / h;
+
+    startx = stepx - 1;
+    starty = stepy - 1;
+
+    blitwidth = 0;
+    for (x = startx; x < (SCREENWIDTH << FRACBITS); x += stepx)
+        ++blitwidth;
+    blitcolumns = realloc(blitcolumns, blitwidth * sizeof(*blitcolumns));
+
+    blitgatherwidth = 0;
+    for (i = 0, x = startx; i < blitwidth; ++i, x += stepx)
     {
+        blitcolumns[i] = x >> FRACBITS;
+        if (blitcolumns[i] <= SCREENWIDTH - 4)
+            blitgatherwidth = i + 1;
+    }
+    blitgatherwidth &= ~15;
+
+    blitrowcount = 0;
+    for (y = starty; y < (SCREENHEIGHT << FRACBITS); y += stepy)
+        ++blitrowcount;
+    blitrows = realloc(blitrows, blitrowcount * sizeof(*blitrows));
+
+    for (i = 0, y = starty; i < blitrowcount; ++i, y += stepy)
+        blitrows[i] = y >> FRACBITS;
+
+    stretchrow = StretchRow;
+#if defined(X86_CPU)
+    if (I_GetCPUFeatures() & CPU_AVX2)
+        stretchrow = StretchRowAVX2;
+#endif
+}
+
+//
+// StretchBlit
+// Stretches each row of screens[0] that appears in screenbuffer once, and
+//  copies it again wherever it is repeated further down.
+//
+static void StretchBlit(void)
+{
+    byte        *dest = pixels;
+    int         lastrow = blitheight >> FRACBITS;
+    int         i;
+
+    for (i = 0; i < blitrowcount && blitrows[i] < lastrow; ++i, dest += pitch)
+    {
+        if (i && blitrows[i] == blitrows[i - 1])
+            memcpy(dest, dest - pitch, blitwidth);
+        else
+            stretchrow(rows[blitrows[i]], dest);
+    }
+}
+#endif
+
 #if defined(SDL20)
-        static int      pitch = SCREENWIDTH * sizeof(Uint32);
-#else
-        if (need_resize)
+//
+// I_ExpandPalette
+// Converts count 8-bit pixels to 32-bit ones through rgbpalette.
+//
+static void I_ExpandPalette(const byte *src, Uint32 *dest, int count)
+{
+    const Uint32        *pal = rgbpalette;
+
+    while (count >= 4)
+    {
+        dest[0] = pal[src[0]];
+        dest[1] = pal[src[1]];
+        dest[2] = pal[src[2]];
+        dest[3] = pal[src[3]];
+        src += 4;
+        dest += 4;
+        count -= 4;
+    }
+
+    while (count--)
+        *dest++ = pal[*src++];
+}
+
+#if defined(X86_CPU)
+//
+// I_ExpandPaletteSSE2
+// Same as I_ExpandPalette, but assembles and stores 16 pixels at a time.
+//
+TARGET("sse2") static void I_ExpandPaletteSSE2(const byte *src, Uint32 *dest, int count)
+{
+    const Uint32        *pal = rgbpalette;
+
+    while (count >= 16)
+    {
+        _mm_storeu_si128((__m128i *)dest, _mm_setr_epi32(pal[src[0]], pal[src[1]],
+            pal[src[2]], pal[src[3]]));
+        _mm_storeu_si128((__m128i *)(dest + 4), _mm_setr_epi32(pal[src[4]],
+            pal[src[5]], pal[src[6]], pal[src[7]]));
+        _mm_storeu_si128((__m128i *)(dest + 8), _mm_setr_epi32(pal[src[8]],
+            pal[src[9]], pal[src[10]], pal[src[11]]));
+        _mm_storeu_si128((__m128i *)(dest + 12), _mm_setr_epi32(pal[src[12]],
+            pal[src[13]], pal[src[14]], pal[src[15]]));
+        src += 16;
+        dest += 16;
+        count -= 16;
+    }
+
+    I_ExpandPalette(src, dest, count);
+}
+
+//
+// I_ExpandPaletteAVX2
+// Same as I_ExpandPalette, but looks up 8 pixels at a time with a gather.
+//
+TARGET("avx2") static void I_ExpandPaletteAVX2(const byte *src, Uint32 *dest, int count)
+{
+    const Uint32        *pal = rgbpalette;
+
+    while (count >= 16)
+    {
+        __m128i indices = _mm_loadu_si128((const __m128i *)src);
+
+        _mm256_storeu_si256((__m256i *)dest, _mm256_i32gather_epi32((const int *)pal,
+            _mm256_cvtepu8_epi32(indices), 4));
+        _mm256_storeu_si256((__m256i *)(dest + 8), _mm256_i32gather_epi32((const int *)pal,
+            _mm256_cvtepu8_epi32(_mm_srli_si128(indices, 8)), 4));
+        src += 16;
+        dest += 16;
+        count -= 16;
+    }
+
+    I_ExpandPalette(src, dest, count);
+}
+#endif
+
+//
+// I_UpdateTexture
+// Expands the visible part of screens[0] straight into the streaming
+//  texture, instead of blitting it to a 32-bit surface and copying that.
+//
+static void I_UpdateTexture(void)
+{
+    byte        *pixels;
+    int         pitch;
+
+    if (SDL_LockTexture(texture, NULL, (void **)&pixels, &pitch) < 0)
+        return;
+
+    if (pitch == SCREENWIDTH * sizeof(Uint32))
+        expandpalette(screens[0], (Uint32 *)pixels, SCREENWIDTH * src_rect.h);
+    else
+    {
+        int     y;
+
+        for (y = 0; y < src_rect.h; ++y)
+            expandpalette(screens[0] + y * SCREENWIDTH, (Uint32 *)(pixels + y * pitch),
+                SCREENWIDTH);
+    }
+
+    SDL_UnlockTexture(texture);
+}
+
+//
+// I_BenchmarkUpdateTexture
+// Times I_UpdateTexture with the current palette expansion function.
+//
+static void I_BenchmarkUpdateTexture(char *name, int frames)
+{
+    uint64_t    start = I_GetTimeUS();
+    int         i;
+
+    for (i = 0; i < frames; i++)
+        I_UpdateTexture();
+
+    C_Output("%s: %.1f us per frame.", name, (I_GetTimeUS() - start) / (double)frames);
+}
+
+//
+// I_BenchmarkPaletteExpansion
+// Times getting a frame into the texture with SDL's blitter and an
+//  intermediate surface, and with each of the palette expansion functions.
+//
+void I_BenchmarkPaletteExpansion(int frames)
+{
+    void        (*expand)(const byte *, Uint32 *, int) = expandpalette;
+    SDL_Surface *rgbbuffer = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 32, 0, 0, 0, 0);
+
+    if (rgbbuffer)
+    {
+        uint64_t        start = I_GetTimeUS();
+        int             i;
+
+        SDL_SetPaletteColors(screenbuffer->format->palette, palette, 0, 256);
+
+        for (i = 0; i < frames; i++)
         {
-            ApplyWindowResize(resize_h);
-            need_resize = false;
-            palette_to_set = true;
+            SDL_LowerBlit(screenbuffer, &screenbuffer->clip_rect, rgbbuffer, &rgbbuffer->clip_rect);
+            SDL_UpdateTexture(texture, NULL, rgbbuffer->pixels, rgbbuffer->pitch);
         }
+
+        C_Output("SDL_LowerBlit + SDL_UpdateTexture: %.1f us per frame.",
+            (I_GetTimeUS() - start) / (double)frames);
+        SDL_FreeSurface(rgbbuffer);
+    }
+
+    expandpalette = I_ExpandPalette;
+    I_BenchmarkUpdateTexture("I_ExpandPalette", frames);
+
+#if defined(X86_CPU)
+    if (I_GetCPUFeatures() & CPU_SSE2)
+    {
+        expandpalette = I_ExpandPaletteSSE2;
+        I_BenchmarkUpdateTexture("I_ExpandPaletteSSE2", frames);
+    }
+
+    if (I_GetCPUFeatures() & CPU_AVX2)
+    {
+        expandpalette = I_ExpandPaletteAVX2;
+        I_BenchmarkUpdateTexture("I_ExpandPaletteAVX2", frames);
+    }
 #endif
 
-        UpdateGrab();
+    expandpalette = expand;
+}
+#endif
 
-        if (!screenvisible)
-            return;
+//
+// I_InitPlayPalettes
+// Applies the current gamma correction level to every palette in PLAYPAL,
+//  so switching between them is just a matter of switching pointers.
+//
+static void I_InitPlayPalettes(void)
+{
+    int         lump = W_GetNumForName("PLAYPAL");
+    byte        *doompalette = W_CacheLumpNum(lump, PU_CACHE);
+    int         i, j;
 
-        if (palette_to_set)
+    numplaypals = BETWEEN(1, W_LumpLength(lump) / 768, NUMPLAYPALS);
+
+    for (i = 0; i < numplaypals; ++i)
+        for (j = 0; j < 256; ++j)
         {
+            SDL_Color   *color = &playpals[i][j];
+
+            color->r = gammatable[gammaindex][*doompalette++];
+            color->g = gammatable[gammaindex][*doompalette++];
+            color->b = gammatable[gammaindex][*doompalette++];
 #if defined(SDL20)
-            SDL_SetPaletteColors(screenbuffer->format->palette, palette, 0, 256);
-#else
-            SDL_SetColors(screenbuffer, palette, 0, 256);
+            rgbplaypals[i][j] = (color->r << 16) | (color->g << 8) | color->b;
+#endif
+        }
+
+    playpalgamma = gammaindex;
+}
+
+//
+// I_UpdatePalette
+// Points palette, and rgbpalette that screens[0] is expanded into the texture
+//  with, at the palette last set.
+//
+static void I_UpdatePalette(void)
+{
+    if (playpalindex >= 0)
+    {
+        int     index;
+
+        if (playpalgamma != gammaindex)
+            I_InitPlayPalettes();
+
+        index = (playpalindex < numplaypals ? playpalindex : 0);
+        palette = playpals[index];
+#if defined(SDL20)
+        rgbpalette = rgbplaypals[index];
+#endif
+    }
+    else
+    {
+#if defined(SDL20)
+        int     i;
+
+        for (i = 0; i < 256; ++i)
+            rgbcustompal[i] = (custompal[i].r << 16) | (custompal[i].g << 8) | custompal[i].b;
+        rgbpalette = rgbcustompal;
+#endif
+        palette = custompal;
+    }
+
+#if !defined(SDL20)
+    if (!headless)
+        SDL_SetColors(screenbuffer, palette, 0, 256);
+#endif
+
+    palette_to_set = false;
+}
+
+//
+// I_HashFrame
+// Hashes screens[0] and the palette it's shown with, 64 bits at a time, and
+//  adds that to the hash of all the frames so far.
+//
+static void I_HashFrame(void)
+{
+    uint64_t    hash = 0xcbf29ce484222325ull;
+    byte        *src = screens[0];
+    byte        *end = src + SCREENWIDTH * SCREENHEIGHT;
+    int         i;
+
+    for (i = 0; i < 256; ++i)
+        hash = (hash ^ ((palette[i].r << 16) | (palette[i].g << 8) | palette[i].b))
+            * 0x100000001b3ull;
+
+    while (src < end)
+    {
+        uint64_t        word;
+
+        memcpy(&word, src, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ull;
+        src += sizeof(word);
+    }
+
+    fprintf(framehashfile, "%i,%016llx\n", framehashes++, (unsigned long long)hash);
+    framehash = (framehash ^ hash) * 0x100000001b3ull;
+}
+
+//
+// I_FinishUpdate
+//
+void I_FinishUpdate(void)
+{
+    static int  tic = 0;
+
+    if (!capfps || tic != gametic || wipe)
+    {
+        tic = gametic;
+
+        if (!headless)
+        {
+#if !defined(SDL20)
+            if (need_resize)
+            {
+                ApplyWindowResize(resize_h);
+                need_resize = false;
+                palette_to_set = true;
+            }
 #endif
 
-            palette_to_set = false;
+            UpdateGrab();
+        }
+
+        if (palette_to_set)
+            I_UpdatePalette();
+
+        // hash or capture the frame before anything can stop it from being
+        //  presented, so -headless gives the same frames as a window does
+        if (framehashfile)
+            I_HashFrame();
+        I_UpdateCapture();
+
+        if (headless || !screenvisible)
+        {
+            framefinished = I_GetTimeUS();
+            return;
         }
 
 #if defined(SDL20)
-        SDL_LowerBlit(screenbuffer, &screenbuffer_rect, rgbbuffer, &rgbbuffer_rect);
-        SDL_UpdateTexture(texture, NULL, rgbbuffer->pixels, pitch);
+        I_UpdateTexture();
         SDL_RenderClear(renderer);
         SDL_RenderCopy(renderer, texture, &src_rect, NULL);
+        framefinished = I_GetTimeUS();
         SDL_RenderPresent(renderer);
 #else
         StretchBlit();
@@ -891,6 +1309,7 @@ void I_FinishUpdate(void)
 #endif
 
         SDL_LowerBlit(screenbuffer, &src_rect, screen, &dest_rect);
+        framefinished = I_GetTimeUS();
         SDL_Flip(screen);
 #endif
 
@@ -910,7 +1329,6 @@ void I_FinishUpdate(void)
             }
         }
     }
-    tic = gametic;
 }
 
 //
@@ -923,6 +1341,7 @@ void I_ReadScreen(byte *scr)
 
 //
 // I_SetPalette
+// Sets a palette that isn't in PLAYPAL, such as the one for the splash screen.
 //
 void I_SetPalette(byte *doompalette)
 {
@@ -930,11 +1349,22 @@ void I_SetPalette(byte *doompalette)
 
     for (i = 0; i < 256; ++i)
     {
-        palette[i].r = gammatable[gammaindex][*doompalette++];
-        palette[i].g = gammatable[gammaindex][*doompalette++];
-        palette[i].b = gammatable[gammaindex][*doompalette++];
+        custompal[i].r = gammatable[gammaindex][*doompalette++];
+        custompal[i].g = gammatable[gammaindex][*doompalette++];
+        custompal[i].b = gammatable[gammaindex][*doompalette++];
     }
 
+    playpalindex = -1;
+    palette_to_set = true;
+}
+
+//
+// I_SetPlayPalette
+// Sets one of the palettes in PLAYPAL.
+//
+void I_SetPlayPalette(int index)
+{
+    playpalindex = index;
     palette_to_set = true;
 }
 
@@ -1002,8 +1432,6 @@ static void SetupScreenRects(void)
 #if defined(SDL20)
     src_rect.w = SCREENWIDTH;
     src_rect.h = SCREENHEIGHT - SBARHEIGHT * widescreen;
-    screenbuffer_rect = screenbuffer->clip_rect;
-    rgbbuffer_rect = rgbbuffer->clip_rect;
 #else
     int w = screenbuffer->w;
     int h = screenbuffer->h;
@@ -1215,11 +1643,17 @@ static void SetVideoMode(boolean output)
         }
     }
     screenbuffer = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 8, 0, 0, 0, 0);
-    rgbbuffer = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 32, 0, 0, 0, 0);
-    SDL_FillRect(rgbbuffer, NULL, 0);
     texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB888, SDL_TEXTUREACCESS_STREAMING,
         SCREENWIDTH, SCREENHEIGHT);
 
+    expandpalette = I_ExpandPalette;
+#if defined(X86_CPU)
+    if (I_GetCPUFeatures() & CPU_AVX2)
+        expandpalette = I_ExpandPaletteAVX2;
+    else if (I_GetCPUFeatures() & CPU_SSE2)
+        expandpalette = I_ExpandPaletteSSE2;
+#endif
+
     SetupScreenRects();
 #else
     int width;
@@ -1293,19 +1727,19 @@ static void SetVideoMode(boolean output)
 
     SetupScreenRects();
 
-    pitch = screenbuffer->pitch;
-    pixels = (byte *)screenbuffer->pixels;
-
-    stepx = (SCREENWIDTH << FRACBITS) / width;
-    stepy = (SCREENHEIGHT << FRACBITS) / height;
-
-    startx = stepx - 1;
-    starty = stepy - 1;
+    SetupStretchBlit(width, height);
 #endif
 }
 
 void ToggleWidescreen(boolean toggle)
 {
+    if (headless)
+    {
+        widescreen = toggle;
+        returntowidescreen = false;
+        return;
+    }
+
 #if defined(SDL20)
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderClear(renderer);
@@ -1400,14 +1834,7 @@ void ToggleWidescreen(boolean toggle)
 
     SetupScreenRects();
 
-    pitch = screenbuffer->pitch;
-    pixels = (byte *)screenbuffer->pixels;
-
-    stepx = (SCREENWIDTH << FRACBITS) / width;
-    stepy = (SCREENHEIGHT << FRACBITS) / height;
-
-    startx = stepx - 1;
-    starty = stepy - 1;
+    SetupStretchBlit(width, height);
 
     palette_to_set = true;
 #endif
@@ -1415,6 +1842,9 @@ void ToggleWidescreen(boolean toggle)
 
 void I_RestartGraphics(void)
 {
+    if (headless)
+        return;
+
     FreeSurfaces();
     SetVideoMode(false);
     if (widescreen)
@@ -1427,6 +1857,9 @@ void I_InitWindows32(void);
 
 void ToggleFullscreen(void)
 {
+    if (headless)
+        return;
+
     fullscreen = !fullscreen;
     M_SaveDefaults();
 #if defined(SDL20)
@@ -1544,14 +1977,7 @@ void ToggleFullscreen(void)
 
     SetupScreenRects();
 
-    pitch = screenbuffer->pitch;
-    pixels = (byte *)screenbuffer->pixels;
-
-    stepx = (SCREENWIDTH << FRACBITS) / width;
-    stepy = (SCREENHEIGHT << FRACBITS) / height;
-
-    startx = stepx - 1;
-    starty = stepy - 1;
+    SetupStretchBlit(width, height);
 #endif
 }
 
@@ -1578,14 +2004,7 @@ void ApplyWindowResize(int resize_h)
 
     SetupScreenRects();
 
-    pitch = screenbuffer->pitch;
-    pixels = (byte *)screenbuffer->pixels;
-
-    stepx = (SCREENWIDTH << FRACBITS) / windowwidth;
-    stepy = (SCREENHEIGHT << FRACBITS) / height;
-
-    startx = stepx - 1;
-    starty = stepy - 1;
+    SetupStretchBlit(windowwidth, height);
 
     M_SaveDefaults();
 
@@ -1679,6 +2098,35 @@ void I_InitGraphics(void)
     I_InitTintTables(doompal);
 
     I_InitGammaTables();
+    I_InitPlayPalettes();
+
+    if ((i = M_CheckParmWithArgs("-framehashes", 1)))
+    {
+        if ((framehashfile = fopen(myargv[i + 1], "w")))
+        {
+            C_Output("Found -FRAMEHASHES parameter on command-line. The hash of every frame will "
+                "be written to %s.", uppercase(myargv[i + 1]));
+            fputs("frame,hash\n", framehashfile);
+            framehash = 0xcbf29ce484222325ull;
+        }
+        else
+            C_Warning("%s couldn't be opened.", uppercase(myargv[i + 1]));
+    }
+
+    if ((headless = M_CheckParm("-headless")))
+    {
+        // no window, no video subsystem and nothing presented
+        C_Output("Found -HEADLESS parameter on command-line. Nothing will be displayed.");
+
+        I_SetPlayPalette(0);
+        screens[0] = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
+        memset(screens[0], 0, SCREENWIDTH * SCREENHEIGHT);
+        for (i = 0; i < SCREENHEIGHT; i++)
+            rows[i] = *screens + i * SCREENWIDTH;
+
+        screenvisible = true;
+        return;
+    }
 
     if (videodriver != NULL && strlen(videodriver) > 0)
     {
@@ -1738,12 +2186,11 @@ void I_InitGraphics(void)
     SDL_WM_SetCaption(PACKAGE_NAME, NULL);
 #endif
 
-    I_SetPalette(doompal);
+    I_SetPlayPalette(0);
+    I_UpdatePalette();
 
 #if defined(SDL20)
     SDL_SetPaletteColors(screenbuffer->format->palette, palette, 0, 256);
-#else
-    SDL_SetColors(screenbuffer, palette, 0, 256);
 #endif
 
     if (!fullscreen)
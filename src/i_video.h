@@ -66,9 +66,14 @@ void I_ShutdownKeyboard(void);
 
 // Takes full 8 bit values.
 void I_SetPalette(byte *palette);
+void I_SetPlayPalette(int index);
 
 void I_FinishUpdate(void);
 
+#if defined(SDL20)
+void I_BenchmarkPaletteExpansion(int frames);
+#endif
+
 #if !defined(SDL20)
 void ApplyWindowResize(int resize_h);
 #endif
@@ -85,6 +90,8 @@ void M_QuitDOOM(int choice);
 void R_SetViewSize(int blocks);
 
 extern boolean  screenvisible;
+extern boolean  headless;
+extern uint64_t framefinished;
 
 extern float    mouse_acceleration;
 extern int      mouse_threshold;
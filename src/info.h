@@ -1457,6 +1457,9 @@ typedef enum
     NUMMOBJTYPES
 } mobjtype_t;
 
+// defined in r_draw.h
+typedef struct colcontext_s colcontext_t;
+
 typedef struct
 {
     int         doomednum;
@@ -1491,7 +1494,7 @@ typedef struct
     char        *plural1;
     char        *name2;
     char        *plural2;
-    void        (*colfunc)(void);
+    void        (*colfunc)(colcontext_t *);
     boolean     canmodify;
 } mobjinfo_t;
 
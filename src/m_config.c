@@ -43,6 +43,7 @@
 
 #include "c_console.h"
 #include "doomstat.h"
+#include "g_game.h"
 #include "i_gamepad.h"
 #include "i_video.h"
 #include "m_argv.h"
@@ -67,6 +68,7 @@ extern boolean  animatedliquid;
 extern boolean  brightmaps;
 extern boolean  capfps;
 extern boolean  centerweapon;
+extern boolean  columnmajor;
 extern boolean  corpses_mirror;
 extern boolean  corpses_moreblood;
 extern boolean  corpses_slide;
@@ -161,6 +163,7 @@ extern char     *pixelsize;
 extern int      pixelwidth;
 extern int      playerbob;
 extern char     *playername;
+extern int      renderthreads;
 extern int      runcount;
 #if defined(SDL20)
 extern char     *scaledriver;
@@ -178,6 +181,7 @@ extern boolean  smoketrails;
 extern int      snd_maxslicetime_ms;
 extern boolean  spritefixes;
 extern boolean  swirlingliquid;
+extern int      targetfps;
 extern char     *timidity_cfg_path;
 extern boolean  translucency;
 #if !defined(WIN32) || !defined(SDL20)
@@ -297,6 +301,7 @@ static default_t cvars[] =
     CONFIG_VARIABLE_INT_PERCENT  (pm_walkbob,              playerbob,                     0),
     CONFIG_VARIABLE_INT          (runcount,                runcount,                      0),
     CONFIG_VARIABLE_INT          (r_brightmaps,            brightmaps,                    1),
+    CONFIG_VARIABLE_INT          (r_columnmajor,           columnmajor,                   1),
     CONFIG_VARIABLE_INT          (r_corpses_mirrored,      corpses_mirror,                1),
     CONFIG_VARIABLE_INT          (r_corpses_moreblood,     corpses_moreblood,             1),
     CONFIG_VARIABLE_INT          (r_corpses_slide,         corpses_slide,                 1),
@@ -315,6 +320,8 @@ static default_t cvars[] =
     CONFIG_VARIABLE_INT          (r_mirrorweapons,         mirrorweapons,                 1),
     CONFIG_VARIABLE_INT          (r_rockettrails,          smoketrails,                   1),
     CONFIG_VARIABLE_INT          (r_shadows,               shadows,                       1),
+    CONFIG_VARIABLE_INT          (r_targetfps,             targetfps,                     0),
+    CONFIG_VARIABLE_INT          (r_threads,               renderthreads,                 0),
     CONFIG_VARIABLE_INT          (r_translucency,          translucency,                  1),
     CONFIG_VARIABLE_INT          (r_viewsize,              screensize,                    0),
     CONFIG_VARIABLE_INT          (s_maxslicetime,          snd_maxslicetime_ms,           0),
@@ -781,7 +788,15 @@ void M_SaveDefaults(void)
 {
     if (returntowidescreen)
         widescreen = true;
+
+    // save the player's own options, not those of a demo being played back
+    if (demoplayback)
+        G_SwapDemoOptions();
+
     SaveDefaultCollection();
+
+    if (demoplayback)
+        G_SwapDemoOptions();
     if (returntowidescreen)
         widescreen = false;
 }
@@ -803,6 +818,9 @@ static void M_CheckDefaults(void)
     if (centerweapon != false && centerweapon != true)
         centerweapon = CENTERWEAPON_DEFAULT;
 
+    if (columnmajor != false && columnmajor != true)
+        columnmajor = COLUMNMAJOR_DEFAULT;
+
     if (corpses_mirror != false && corpses_mirror != true)
         corpses_mirror = CORPSES_MIRROR_DEFAULT;
 
@@ -1108,6 +1126,8 @@ static void M_CheckDefaults(void)
 
     playerbob = BETWEEN(PLAYERBOB_MIN, playerbob, PLAYERBOB_MAX);
 
+    renderthreads = BETWEEN(RENDERTHREADS_MIN, renderthreads, RENDERTHREADS_MAX);
+
     if (am_rotatemode != false && am_rotatemode != true)
         am_rotatemode = ROTATEMODE_DEFAULT;
 
@@ -1155,6 +1175,8 @@ static void M_CheckDefaults(void)
     if (swirlingliquid != false && swirlingliquid != true)
         swirlingliquid = SWIRLINGLIQUID_DEFAULT;
 
+    targetfps = BETWEEN(TARGETFPS_MIN, targetfps, TARGETFPS_MAX);
+
     if (translucency != false && translucency != true)
         translucency = TRANSLUCENCY_DEFAULT;
 
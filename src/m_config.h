@@ -51,6 +51,8 @@
 
 #define CENTERWEAPON_DEFAULT                    true
 
+#define COLUMNMAJOR_DEFAULT                     false
+
 #define CORPSES_MIRROR_DEFAULT                  true
 
 #define CORPSES_MOREBLOOD_DEFAULT               true
@@ -260,11 +262,11 @@
 
 #define PIXELWIDTH_MIN                          2
 #define PIXELWIDTH_DEFAULT                      2
-#define PIXELWIDTH_MAX                          SCREENWIDTH
+#define PIXELWIDTH_MAX                          16
 
 #define PIXELHEIGHT_MIN                         2
 #define PIXELHEIGHT_DEFAULT                     2
-#define PIXELHEIGHT_MAX                         SCREENHEIGHT
+#define PIXELHEIGHT_MAX                         16
 
 #define PIXELSIZE_DEFAULT                       "2x2"
 
@@ -274,6 +276,10 @@
 
 #define PLAYERNAME_DEFAULT                      "you"
 
+#define RENDERTHREADS_MIN                       1
+#define RENDERTHREADS_DEFAULT                   1
+#define RENDERTHREADS_MAX                       16
+
 #define ROTATEMODE_DEFAULT                      true
 
 #define RUNCOUNT_MAX                            32768
@@ -320,10 +326,18 @@
 
 #define SWIRLINGLIQUID_DEFAULT                  true
 
+#define TARGETFPS_MIN                           0
+#define TARGETFPS_DEFAULT                       0
+#define TARGETFPS_MAX                           1000
+
 #define TIMIDITY_CFG_PATH_DEFAULT               ""
 
 #define TRANSLUCENCY_DEFAULT                    true
 
+#define VIEWSCALE_MIN                           50
+#define VIEWSCALE_DEFAULT                       100
+#define VIEWSCALE_MAX                           100
+
 #if defined(WIN32)
 #define VIDEODRIVER_DEFAULT                     "windows"
 #else
@@ -77,6 +77,8 @@ extern boolean  splashscreen;
 
 extern boolean  skipaction;
 
+extern boolean  setsizeneeded;
+
 //
 // defaulted values
 //
@@ -530,7 +532,7 @@ void M_DarkBackground(void)
         screens[0][i] = tinttab50[blurredscreen[i]];
 
     if (graphicdetail == LOW)
-        V_LowGraphicDetail(SCREENHEIGHT);
+        V_LowGraphicDetail(0, SCREENHEIGHT);
 }
 
 static byte blues[] =
@@ -1914,6 +1916,7 @@ void M_ChangeDetail(int choice)
 {
     blurred = false;
     graphicdetail = !graphicdetail;
+    setsizeneeded = true;
     C_Input("r_graphicdetail %s", (graphicdetail == HIGH ? "high" : "low"));
     if (!menuactive)
     {
@@ -2240,7 +2243,7 @@ void M_ChangeGamma(boolean shift)
     message_dontpause = true;
     message_dontfuckwithme = true;
 
-    I_SetPalette((byte *)W_CacheLumpName("PLAYPAL", PU_CACHE) + st_palette * 768);
+    I_SetPlayPalette(st_palette);
     M_SaveDefaults();
 }
 
@@ -3161,7 +3164,7 @@ void M_StartControlPanel(void)
     }
 
     players[0].fixedcolormap = 0;
-    I_SetPalette(W_CacheLumpName("PLAYPAL", PU_CACHE));
+    I_SetPlayPalette(0);
 }
 
 //
@@ -3197,7 +3200,7 @@ void M_Drawer(void)
         M_DarkBackground();
 
         if (widescreen)
-            y = viewwindowy / 2 + (viewheight / 2 - M_StringHeight(messageString)) / 2 - 1;
+            y = viewwindowy / 2 + (scaledviewheight / 2 - M_StringHeight(messageString)) / 2 - 1;
         else
             y = (ORIGINALHEIGHT - M_StringHeight(messageString)) / 2 - 1;
         while (messageString[start] != '\0')
@@ -3318,7 +3321,7 @@ void M_ClearMenus(void)
         XInputVibration(idlemotorspeed);
     }
 
-    I_SetPalette((byte *)W_CacheLumpName("PLAYPAL", PU_CACHE) + st_palette * 768);
+    I_SetPlayPalette(st_palette);
 }
 
 //
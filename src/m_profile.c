@@ -0,0 +1,244 @@
+/*
+========================================================================
+
+                               DOOM RETRO
+         The classic, refined DOOM source port. For Windows PC.
+
+========================================================================
+
+  Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+  Copyright (C) 2013-2015 Brad Harding.
+
+  DOOM RETRO is a fork of CHOCOLATE DOOM by Simon Howard.
+  For a complete list of credits, see the accompanying AUTHORS file.
+
+  This file is part of DOOM RETRO.
+
+  DOOM RETRO is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  DOOM RETRO is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with DOOM RETRO. If not, see <http://www.gnu.org/licenses/>.
+
+  DOOM is a registered trademark of id Software LLC, a ZeniMax Media
+  company, in the US and/or other countries and is used without
+  permission. All other trademarks are the property of their respective
+  holders. DOOM RETRO is in no way affiliated with nor endorsed by
+  id Software LLC.
+
+========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "i_timer.h"
+#include "m_fixed.h"
+#include "m_misc.h"
+#include "m_profile.h"
+
+char *profilestagenames[NUMPROFILESTAGES] =
+{
+    "Ticker", "Setup", "BSP", "Planes", "Masked", "HUD", "Automap", "Blit", "Frame"
+};
+
+// Stats shown by the com_showperf overlay, updated twice a second so
+//  they can be read
+profilestats_t          profilesummary[NUMPROFILESTAGES];
+boolean                 showperf = false;
+
+static boolean          profilerequested;
+
+static uint64_t         stagestart[NUMPROFILESTAGES];
+static int              stagetime[NUMPROFILESTAGES];
+
+// Times of each stage over the last PROFILEFRAMES frames
+static int              samples[NUMPROFILESTAGES][PROFILEFRAMES];
+static int              numsamples;
+static int              nextsample;
+
+static uint64_t         lastframe;
+static uint64_t         lastsummary;
+
+static FILE             *profilelog;
+static char             profilelogname[260];
+static int              profilelogframe;
+
+boolean M_Profiling(void)
+{
+    return (showperf || profilelog || profilerequested);
+}
+
+void M_StartProfiling(void)
+{
+    profilerequested = true;
+}
+
+void M_ProfileBegin(profilestage_t stage)
+{
+    if (!M_Profiling())
+        return;
+
+    stagestart[stage] = I_GetTimeUS();
+}
+
+void M_ProfileEnd(profilestage_t stage)
+{
+    if (!M_Profiling())
+        return;
+
+    stagetime[stage] += (int)(I_GetTimeUS() - stagestart[stage]);
+}
+
+void M_ProfileAdd(profilestage_t stage, int time)
+{
+    if (!M_Profiling())
+        return;
+
+    stagetime[stage] += time;
+}
+
+//
+// M_ProfileFrame
+// Adds the times of the frame just displayed to the rolling window and
+//  the log, and starts timing the next one.
+//
+void M_ProfileFrame(void)
+{
+    uint64_t    now;
+    int         i;
+
+    // start again from the next frame once the profiler is turned back on
+    if (!M_Profiling())
+    {
+        lastframe = 0;
+        memset(stagetime, 0, sizeof(stagetime));
+        return;
+    }
+
+    now = I_GetTimeUS();
+
+    if (lastframe)
+    {
+        stagetime[PROFILE_FRAME] = (int)(now - lastframe);
+
+        for (i = 0; i < NUMPROFILESTAGES; ++i)
+            samples[i][nextsample] = stagetime[i];
+        nextsample = (nextsample + 1) % PROFILEFRAMES;
+        numsamples = MIN(numsamples + 1, PROFILEFRAMES);
+
+        if (profilelog)
+        {
+            fprintf(profilelog, "%i", ++profilelogframe);
+            for (i = 0; i < NUMPROFILESTAGES; ++i)
+                fprintf(profilelog, ",%i", stagetime[i]);
+            fputc('\n', profilelog);
+        }
+
+        if (showperf && now - lastsummary >= 500000)
+        {
+            for (i = 0; i < NUMPROFILESTAGES; ++i)
+                M_GetProfileStats((profilestage_t)i, &profilesummary[i]);
+            lastsummary = now;
+        }
+    }
+
+    lastframe = now;
+    memset(stagetime, 0, sizeof(stagetime));
+}
+
+void M_ProfileReset(void)
+{
+    numsamples = 0;
+    nextsample = 0;
+    lastframe = 0;
+    memset(stagetime, 0, sizeof(stagetime));
+    memset(profilesummary, 0, sizeof(profilesummary));
+}
+
+int M_ProfileFrames(void)
+{
+    return numsamples;
+}
+
+static int CompareTimes(const void *a, const void *b)
+{
+    return (*(const int *)a - *(const int *)b);
+}
+
+//
+// M_GetProfileStats
+// Works out the min, average, max and percentiles of a stage's times over
+//  the frames in the rolling window.
+//
+void M_GetProfileStats(profilestage_t stage, profilestats_t *stats)
+{
+    int         sorted[PROFILEFRAMES];
+    int64_t     total = 0;
+    int         i;
+
+    memset(stats, 0, sizeof(*stats));
+
+    if (!numsamples)
+        return;
+
+    memcpy(sorted, samples[stage], numsamples * sizeof(*sorted));
+    qsort(sorted, numsamples, sizeof(*sorted), CompareTimes);
+
+    for (i = 0; i < numsamples; ++i)
+        total += sorted[i];
+
+    stats->min = sorted[0];
+    stats->avg = (int)(total / numsamples);
+    stats->max = sorted[numsamples - 1];
+    stats->p50 = sorted[(numsamples - 1) * 50 / 100];
+    stats->p95 = sorted[(numsamples - 1) * 95 / 100];
+    stats->p99 = sorted[(numsamples - 1) * 99 / 100];
+}
+
+//
+// M_StartProfileLog
+// Opens a CSV file that a row of stage times, in microseconds, is written
+//  to for every frame until M_StopProfileLog is called.
+//
+boolean M_StartProfileLog(char *filename)
+{
+    int i;
+
+    M_StopProfileLog();
+
+    if (!(profilelog = fopen(filename, "wt")))
+        return false;
+
+    M_StringCopy(profilelogname, filename, sizeof(profilelogname));
+    profilelogframe = 0;
+
+    fprintf(profilelog, "frame");
+    for (i = 0; i < NUMPROFILESTAGES; ++i)
+        fprintf(profilelog, ",%s", profilestagenames[i]);
+    fputc('\n', profilelog);
+
+    return true;
+}
+
+void M_StopProfileLog(void)
+{
+    if (profilelog)
+    {
+        fclose(profilelog);
+        profilelog = NULL;
+    }
+}
+
+char *M_ProfileLogName(void)
+{
+    return (profilelog ? profilelogname : NULL);
+}
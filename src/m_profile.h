@@ -0,0 +1,99 @@
+/*
+========================================================================
+
+                               DOOM RETRO
+         The classic, refined DOOM source port. For Windows PC.
+
+========================================================================
+
+  Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+  Copyright (C) 2013-2015 Brad Harding.
+
+  DOOM RETRO is a fork of CHOCOLATE DOOM by Simon Howard.
+  For a complete list of credits, see the accompanying AUTHORS file.
+
+  This file is part of DOOM RETRO.
+
+  DOOM RETRO is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  DOOM RETRO is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with DOOM RETRO. If not, see <http://www.gnu.org/licenses/>.
+
+  DOOM is a registered trademark of id Software LLC, a ZeniMax Media
+  company, in the US and/or other countries and is used without
+  permission. All other trademarks are the property of their respective
+  holders. DOOM RETRO is in no way affiliated with nor endorsed by
+  id Software LLC.
+
+========================================================================
+*/
+
+#if !defined(__M_PROFILE__)
+#define __M_PROFILE__
+
+#include "doomtype.h"
+
+// Stages of a frame that are timed.
+typedef enum
+{
+    PROFILE_TICKER,             // G_Ticker, including P_Ticker
+    PROFILE_SETUPFRAME,         // R_SetupFrame
+    PROFILE_BSP,                // R_RenderBSPNode
+    PROFILE_PLANES,             // R_DrawPlanes
+    PROFILE_MASKED,             // R_DrawMasked
+    PROFILE_HUD,                // HUD and status bar
+    PROFILE_AUTOMAP,            // AM_Drawer
+    PROFILE_BLIT,               // I_FinishUpdate
+    PROFILE_FRAME,              // from the start of one frame to the next
+    NUMPROFILESTAGES
+} profilestage_t;
+
+// Times in microseconds over the last PROFILEFRAMES frames.
+typedef struct
+{
+    int         min;
+    int         avg;
+    int         max;
+    int         p50;
+    int         p95;
+    int         p99;
+} profilestats_t;
+
+#define PROFILEFRAMES   256
+
+extern char             *profilestagenames[NUMPROFILESTAGES];
+extern profilestats_t   profilesummary[NUMPROFILESTAGES];
+extern boolean          showperf;
+
+// Frame times are only collected while com_showperf is on, they're being
+//  logged to a file, or once the perf CCMD has been entered. Until then, the
+//  functions below do nothing.
+boolean M_Profiling(void);
+void M_StartProfiling(void);
+
+// Time a stage of the current frame, adding to any time already spent in it.
+void M_ProfileBegin(profilestage_t stage);
+void M_ProfileEnd(profilestage_t stage);
+void M_ProfileAdd(profilestage_t stage, int time);
+
+// Called once a frame has been displayed.
+void M_ProfileFrame(void);
+
+void M_ProfileReset(void);
+int M_ProfileFrames(void);
+void M_GetProfileStats(profilestage_t stage, profilestats_t *stats);
+
+// Stream the times of every frame to a CSV file.
+boolean M_StartProfileLog(char *filename);
+void M_StopProfileLog(void);
+char *M_ProfileLogName(void);
+
+#endif
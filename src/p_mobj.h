@@ -376,7 +376,7 @@ typedef struct mobj_s
     // For bobbing up and down.
     int                 floatbob;
 
-    void                (*colfunc)(void);
+    void                (*colfunc)(colcontext_t *);
 
     // a linked list of sectors where this object appears
     struct msecnode_s   *touching_sectorlist;   // phares 3/14/98
@@ -0,0 +1,291 @@
+/*
+========================================================================
+
+                               DOOM RETRO
+         The classic, refined DOOM source port. For Windows PC.
+
+========================================================================
+
+  Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+  Copyright (C) 2013-2015 Brad Harding.
+
+  DOOM RETRO is a fork of CHOCOLATE DOOM by Simon Howard.
+  For a complete list of credits, see the accompanying AUTHORS file.
+
+  This file is part of DOOM RETRO.
+
+  DOOM RETRO is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  DOOM RETRO is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with DOOM RETRO. If not, see <http://www.gnu.org/licenses/>.
+
+  DOOM is a registered trademark of id Software LLC, a ZeniMax Media
+  company, in the US and/or other countries and is used without
+  permission. All other trademarks are the property of their respective
+  holders. DOOM RETRO is in no way affiliated with nor endorsed by
+  id Software LLC.
+
+========================================================================
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "doomdata.h"
+#include "doomstat.h"
+#include "i_swap.h"
+#include "i_thread.h"
+#include "info.h"
+#include "m_misc.h"
+#include "p_prefetch.h"
+#include "r_data.h"
+#include "r_state.h"
+#include "s_sound.h"
+#include "sounds.h"
+#include "w_wad.h"
+
+//
+// While the intermission is shown after a level, a prefetch thread reads
+// the lumps the next level will load from disk: its map lumps and music,
+// and the flats, wall patches and sprites it uses. The zone isn't thread
+// safe, so nothing is cached there. The lumps are read into a scratch
+// buffer, which leaves them in the OS's file cache for P_SetupLevel and
+// R_PrecacheLevel to read back without waiting on the disk.
+//
+extern texture_t        **textures;
+extern int              numtextures;
+
+static SDL_Thread       *prefetchthread;
+static volatile boolean prefetchcancel;
+static int              prefetchepisode;
+static int              prefetchmap;
+
+static byte             *prefetched;
+static byte             *prefetchbuffer;
+static int              prefetchbuffersize;
+
+//
+// P_PrefetchLump
+// Read a lump that hasn't been read yet into the scratch buffer.
+//
+static void P_PrefetchLump(int lump)
+{
+    lumpinfo_t  *l;
+
+    if (lump < 0 || lump >= (int)numlumps || prefetched[lump] || prefetchcancel)
+        return;
+
+    prefetched[lump] = 1;
+    l = lumpinfo + lump;
+
+    if (l->size <= 0)
+        return;
+
+    if (l->size > prefetchbuffersize)
+    {
+        byte    *buffer = realloc(prefetchbuffer, l->size);
+
+        if (!buffer)
+            return;
+
+        prefetchbuffer = buffer;
+        prefetchbuffersize = l->size;
+    }
+
+    W_Read(l->wad_file, l->position, prefetchbuffer, l->size);
+}
+
+//
+// P_ReadMapLump
+// Read one of the map lumps, which has already been prefetched, into a
+// buffer that the caller frees.
+//
+static void *P_ReadMapLump(int lump, int *count, size_t size)
+{
+    lumpinfo_t  *l = lumpinfo + lump;
+    void        *data;
+
+    *count = l->size / size;
+
+    if (!*count || !(data = malloc(l->size)))
+    {
+        *count = 0;
+        return NULL;
+    }
+
+    if (W_Read(l->wad_file, l->position, data, l->size) < (size_t)l->size)
+    {
+        free(data);
+        *count = 0;
+        return NULL;
+    }
+
+    return data;
+}
+
+static void P_PrefetchFlat(char *name)
+{
+    int         flat = R_CheckFlatNumForName(name);
+
+    if (flat >= 0)
+        P_PrefetchLump(firstflat + flat);
+}
+
+static void P_PrefetchTexture(char *name)
+{
+    int         texture = R_CheckTextureNumForName(name);
+    int         i;
+
+    if (texture <= 0)
+        return;
+
+    for (i = 0; i < textures[texture]->patchcount; i++)
+        P_PrefetchLump(textures[texture]->patches[i].patch);
+}
+
+static void P_PrefetchThing(int type)
+{
+    int         i;
+    int         j;
+    int         k;
+    spritedef_t *sprite;
+
+    for (i = 0; i < NUMMOBJTYPES; i++)
+        if (mobjinfo[i].doomednum == type)
+            break;
+
+    if (i == NUMMOBJTYPES)
+        return;
+
+    sprite = &sprites[states[mobjinfo[i].spawnstate].sprite];
+
+    for (j = 0; j < sprite->numframes; j++)
+        for (k = 0; k < 8; k++)
+            P_PrefetchLump(firstspritelump + sprite->spriteframes[j].lump[k]);
+}
+
+static int P_PrefetchThread(void *data)
+{
+    char        lumpname[6];
+    char        musicname[9];
+    int         lumpnum;
+    int         count;
+    int         i;
+    mapsector_t *ms;
+    mapsidedef_t *msd;
+    mapthing_t  *mt;
+
+    if (gamemode == commercial)
+        M_snprintf(lumpname, 6, "MAP%02i", prefetchmap);
+    else
+        M_snprintf(lumpname, 5, "E%iM%i", prefetchepisode, prefetchmap);
+
+    if (W_CheckNumForName(lumpname) < 0)
+        return 0;
+
+    if (nerve && gamemission == doom2)
+        lumpnum = W_GetNumForName2(lumpname);
+    else
+        lumpnum = W_GetNumForName(lumpname);
+
+    if (lumpnum + ML_BLOCKMAP >= (int)numlumps)
+        return 0;
+
+    prefetched = calloc(numlumps, 1);
+
+    if (!prefetched)
+        return 0;
+
+    // The map lumps themselves.
+    for (i = ML_THINGS; i <= ML_BLOCKMAP; i++)
+        P_PrefetchLump(lumpnum + i);
+
+    M_snprintf(musicname, sizeof(musicname), "d_%s",
+        S_music[S_GetMusicNum(prefetchepisode, prefetchmap)].name);
+    P_PrefetchLump(W_CheckNumForName(musicname));
+
+    // The flats on the floors and ceilings of sectors.
+    if ((ms = P_ReadMapLump(lumpnum + ML_SECTORS, &count, sizeof(mapsector_t))))
+    {
+        for (i = 0; i < count && !prefetchcancel; i++)
+        {
+            P_PrefetchFlat(ms[i].floorpic);
+            P_PrefetchFlat(ms[i].ceilingpic);
+        }
+
+        free(ms);
+    }
+
+    // The patches of the textures on sidedefs, and the sky.
+    if ((msd = P_ReadMapLump(lumpnum + ML_SIDEDEFS, &count, sizeof(mapsidedef_t))))
+    {
+        for (i = 0; i < count && !prefetchcancel; i++)
+        {
+            P_PrefetchTexture(msd[i].toptexture);
+            P_PrefetchTexture(msd[i].midtexture);
+            P_PrefetchTexture(msd[i].bottomtexture);
+        }
+
+        free(msd);
+    }
+
+    if (gamemode == commercial)
+        P_PrefetchTexture(prefetchmap < 12 ? "SKY1" : (prefetchmap < 21 ? "SKY2" : "SKY3"));
+    else
+    {
+        M_snprintf(lumpname, sizeof(lumpname), "SKY%i", prefetchepisode);
+        P_PrefetchTexture(lumpname);
+    }
+
+    // The sprites of things, in the states they spawn in.
+    if ((mt = P_ReadMapLump(lumpnum + ML_THINGS, &count, sizeof(mapthing_t))))
+    {
+        for (i = 0; i < count && !prefetchcancel; i++)
+            P_PrefetchThing(SHORT(mt[i].type));
+
+        free(mt);
+    }
+
+    free(prefetched);
+    prefetched = NULL;
+
+    return 0;
+}
+
+//
+// P_StartPrefetch
+//
+void P_StartPrefetch(int episode, int map)
+{
+    P_StopPrefetch();
+
+    prefetchepisode = episode;
+    prefetchmap = map;
+    prefetchthread = I_CreateThread(P_PrefetchThread, "prefetch", NULL);
+}
+
+//
+// P_StopPrefetch
+//
+void P_StopPrefetch(void)
+{
+    if (!prefetchthread)
+        return;
+
+    prefetchcancel = true;
+    I_WaitThread(prefetchthread);
+    prefetchthread = NULL;
+    prefetchcancel = false;
+
+    free(prefetchbuffer);
+    prefetchbuffer = NULL;
+    prefetchbuffersize = 0;
+}
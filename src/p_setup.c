@@ -47,6 +47,7 @@
 #include "m_misc.h"
 #include "p_fix.h"
 #include "p_local.h"
+#include "p_prefetch.h"
 #include "p_tick.h"
 #include "s_sound.h"
 #include "w_wad.h"
@@ -1272,11 +1273,16 @@ void P_SetupLevel(int episode, int map)
     else
         M_snprintf(lumpname, 5, "E%iM%i", episode, map);
 
+    P_StopPrefetch();
+
     if (nerve && gamemission == doom2)
         lumpnum = W_GetNumForName2(lumpname);
     else
         lumpnum = W_GetNumForName(lumpname);
 
+    // Start reading the level's lumps from disk before they're loaded.
+    W_PrefetchLumps(lumpnum + 1, ML_BLOCKMAP);
+
     canmodify = ((W_CheckMultipleLumps(lumpname) == 1 || gamemission == pack_nerve
         || (nerve && gamemission == doom2)) && !FREEDOOM);
 
@@ -1310,6 +1316,8 @@ void P_SetupLevel(int episode, int map)
     P_LoadSideDefs2(lumpnum + ML_SIDEDEFS);
     P_LoadLineDefs2(lumpnum + ML_LINEDEFS);
 
+    R_PrefetchLevel();
+
     // note: most of this ordering is important
     if (!samelevel)
         P_LoadBlockMap(lumpnum + ML_BLOCKMAP);
@@ -44,17 +44,17 @@
 #include "r_plane.h"
 #include "r_things.h"
 
-seg_t           *curline;
-side_t          *sidedef;
-line_t          *linedef;
-sector_t        *frontsector;
-sector_t        *backsector;
+THREADLOCAL seg_t           *curline;
+THREADLOCAL side_t          *sidedef;
+THREADLOCAL line_t          *linedef;
+THREADLOCAL sector_t        *frontsector;
+THREADLOCAL sector_t        *backsector;
 
-boolean         doorclosed;
+THREADLOCAL boolean         doorclosed;
 
-drawseg_t       *drawsegs;
-unsigned int    maxdrawsegs;
-drawseg_t       *ds_p;
+THREADLOCAL drawseg_t       *drawsegs;
+THREADLOCAL unsigned int    maxdrawsegs;
+THREADLOCAL drawseg_t       *ds_p;
 
 void R_StoreWallRange(int start, int stop);
 
@@ -96,8 +96,8 @@ typedef struct
 #define MAXSEGS (SCREENWIDTH / 2 + 1)
 
 // newend is one past the last valid seg
-static cliprange_t      *newend;
-static cliprange_t      solidsegs[MAXSEGS];
+static THREADLOCAL cliprange_t      *newend;
+static THREADLOCAL cliprange_t      solidsegs[MAXSEGS];
 
 //
 // R_ClipSolidWallSegment
@@ -257,7 +257,7 @@ boolean R_DoorClosed(void)
 }
 
 // [AM] Interpolate the passed sector, if prudent.
-void R_MaybeInterpolateSector(sector_t* sector)
+static void R_MaybeInterpolateSector(sector_t* sector)
 {
     if (!capfps &&
         // Only if we moved the sector last tic.
@@ -282,6 +282,19 @@ void R_MaybeInterpolateSector(sector_t* sector)
     }
 }
 
+//
+// R_InterpolateSectors
+// Interpolate every sector once at the start of the frame, rather than as
+//  each is visited, so the sectors aren't written to while rendering.
+//
+void R_InterpolateSectors(void)
+{
+    int i;
+
+    for (i = 0; i < numsectors; i++)
+        R_MaybeInterpolateSector(&sectors[i]);
+}
+
 
 //
 // killough 3/7/98: Hack floor/ceiling heights for deep water etc.
@@ -382,7 +395,7 @@ sector_t *R_FakeFlat(sector_t *sec, sector_t *tempsec, int *floorlightlevel,
                 *ceilinglightlevel = (s->ceilinglightsec == -1 ? s->lightlevel :
                     sectors[s->ceilinglightsec].lightlevel);            // killough 4/11/98
         }
-        *sec = *tempsec;             // Use other sector
+        sec = tempsec;              // Use other sector
     }
     return sec;
 }
@@ -400,7 +413,7 @@ static void R_AddLine(seg_t *line)
     angle_t             angle2;
     angle_t             span;
     angle_t             tspan;
-    static sector_t     tempsec;        // killough 3/8/98: ceiling/water hack
+    sector_t            tempsec;        // killough 3/8/98: ceiling/water hack
     curline = line;
 
     angle1 = R_GetVertexViewAngle(line->v1);
@@ -459,11 +472,6 @@ static void R_AddLine(seg_t *line)
     if (!backsector)
         goto clipsolid;
 
-    // [AM] Interpolate sector movement before
-    //      running clipping tests.  Frontsector
-    //      should already be interpolated.
-    R_MaybeInterpolateSector(backsector);
-
     // killough 3/8/98, 4/4/98: hack for invisible ceilings / deep water
     backsector = R_FakeFlat(backsector, &tempsec, NULL, NULL, true);
     doorclosed = false;
@@ -623,21 +631,15 @@ static void R_Subsector(int num)
     int         count = sub->numlines;
     seg_t       *line = &segs[sub->firstline];
 
-    frontsector = sub->sector;
-
-    // [AM] Interpolate sector movement.  Usually only needed
-    //      when you're standing inside the sector.
-    R_MaybeInterpolateSector(frontsector);
-
     // killough 3/8/98, 4/4/98: Deep water / fake ceiling effect
-    frontsector = R_FakeFlat(frontsector, &tempsec, &floorlightlevel, &ceilinglightlevel, false);
+    frontsector = R_FakeFlat(sub->sector, &tempsec, &floorlightlevel, &ceilinglightlevel, false);
 
     if (frontsector->interpfloorheight < viewz
         || (frontsector->heightsec != -1 && sectors[frontsector->heightsec].ceilingpic == skyflatnum))
     {
         floorplane = R_FindPlane(frontsector->interpfloorheight, frontsector->floorpic,
             floorlightlevel, frontsector->floor_xoffs, frontsector->floor_yoffs);
-        floorplane->sector = frontsector;
+        floorplane->sector = sub->sector;
     }
     else
         floorplane = NULL;
@@ -40,10 +40,12 @@
 #include "doomstat.h"
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_thread.h"
 #include "m_misc.h"
 #include "p_local.h"
 #include "p_tick.h"
 #include "r_sky.h"
+#include "w_index.h"
 #include "w_wad.h"
 #include "z_zone.h"
 
@@ -96,7 +98,7 @@ fixed_t         *spritetopoffset;
 
 boolean         spritefixes = SPRITEFIXES_DEFAULT;
 
-boolean         *lookuptextures;
+int             *lookuptextures;
 int             lookupprogress;
 
 static byte notgray[256] =
@@ -261,8 +263,7 @@ void R_DrawColumnInCache(const column_t *patch, byte *cache, int originy,
 //
 static void R_GenerateComposite(int texnum)
 {
-    byte                *block = Z_Malloc(texturecompositesize[texnum], PU_STATIC,
-                                          (void **)&texturecomposite[texnum]);
+    byte                *block = Z_Malloc(texturecompositesize[texnum], PU_STATIC, NULL);
     texture_t           *texture = textures[texnum];
 
     // Composite the columns together.
@@ -336,9 +337,10 @@ static void R_GenerateComposite(int texnum)
     free(source);       // free temporary column
     free(marks);        // free transparency marks
 
-    // Now that the texture has been built in column cache,
-    // it is purgable from zone memory.
-    Z_ChangeTag(block, PU_CACHE);
+    // Only publish the texture once it has been built, as other render
+    // threads may be looking for it without taking the lock. It stays
+    // PU_STATIC, since purging it could free it while they're drawing it.
+    I_StoreReleasePtr((void **)&texturecomposite[texnum], block);
 }
 
 //
@@ -418,9 +420,6 @@ static void R_GenerateLookup(int texnum)
         }
     }
 
-    // -ES- 1998/08/18 We don't have to init this texnum again
-    lookuptextures[texnum] = true;
-
     // Now count the number of columns
     //  that are covered by more than one patch.
     // Fill in the lump / offset, so columns
@@ -456,6 +455,9 @@ static void R_GenerateLookup(int texnum)
         texturecompositesize[texnum] = csize;
     }
     free(count);                                        // killough 4/9/98
+
+    // -ES- 1998/08/18 We don't have to init this texnum again
+    I_StoreReleaseInt(&lookuptextures[texnum], true);
 }
 
 //
@@ -465,9 +467,17 @@ byte *R_GetColumn(int tex, int col)
 {
     int         lump;
     int         ofs;
+    byte        *composite;
 
-    if (lookuptextures[tex] == false)
-        R_GenerateLookup(tex);
+    // lookups and composites are built by whichever render thread needs them
+    // first, so check again once the cache is locked
+    if (!I_LoadAcquireInt(&lookuptextures[tex]))
+    {
+        W_LockCache();
+        if (!lookuptextures[tex])
+            R_GenerateLookup(tex);
+        W_UnlockCache();
+    }
 
     col &= texturewidthmask[tex];
     lump = texturecolumnlump[tex][col];
@@ -476,10 +486,18 @@ byte *R_GetColumn(int tex, int col)
     if (lump > 0)
         return ((byte *)W_CacheLumpNum(lump, PU_CACHE) + ofs);
 
-    if (!texturecomposite[tex])
-        R_GenerateComposite(tex);
+    if (!(composite = I_LoadAcquirePtr((void **)&texturecomposite[tex])))
+    {
+        W_LockCache();
+        if (!(composite = texturecomposite[tex]))
+        {
+            R_GenerateComposite(tex);
+            composite = texturecomposite[tex];
+        }
+        W_UnlockCache();
+    }
 
-    return (texturecomposite[tex] + ofs);
+    return (composite + ofs);
 }
 
 static void GenerateTextureHashTable(void)
@@ -579,6 +597,9 @@ static void R_InitTextures(void)
 
     int          *directory;
 
+    byte         *index;
+    int          indexsize;
+
     // Load the patch names from pnames.lmp.
     name[8] = 0;
     names = (char *)W_CacheLumpName("PNAMES", PU_STATIC);
@@ -682,17 +703,54 @@ static void R_InitTextures(void)
     if (maptex2)
         W_ReleaseLumpName("TEXTURE2");
 
-    lookuptextures = Z_Malloc(numtextures * sizeof(boolean), PU_STATIC, 0);
+    lookuptextures = Z_Malloc(numtextures * sizeof(*lookuptextures), PU_STATIC, 0);
 
     for (i = 0; i < numtextures; i++)
         lookuptextures[i] = false;
 
     lookupprogress = numtextures;
 
-    // Precalculate whatever possible.
-
+    // Precalculate whatever possible, unless it's in the lump index from the
+    //  last launch.
+    indexsize = 0;
     for (i = 0; i < numtextures; i++)
-        R_GenerateLookup(i);
+        indexsize += sizeof(*texturecompositesize) + textures[i]->width
+            * (sizeof(**texturecolumnlump) + sizeof(**texturecolumnofs));
+
+    if ((index = W_GetIndexSection(INDEX_TEXTURES, indexsize)))
+    {
+        for (i = 0; i < numtextures; i++)
+        {
+            int width = textures[i]->width;
+
+            memcpy(&texturecompositesize[i], index, sizeof(*texturecompositesize));
+            index += sizeof(*texturecompositesize);
+            memcpy(texturecolumnlump[i], index, width * sizeof(**texturecolumnlump));
+            index += width * sizeof(**texturecolumnlump);
+            memcpy(texturecolumnofs[i], index, width * sizeof(**texturecolumnofs));
+            index += width * sizeof(**texturecolumnofs);
+            texturecomposite[i] = 0;
+            lookuptextures[i] = true;
+        }
+    }
+    else
+    {
+        index = W_NewIndexSection(INDEX_TEXTURES, indexsize);
+
+        for (i = 0; i < numtextures; i++)
+        {
+            int width = textures[i]->width;
+
+            R_GenerateLookup(i);
+
+            memcpy(index, &texturecompositesize[i], sizeof(*texturecompositesize));
+            index += sizeof(*texturecompositesize);
+            memcpy(index, texturecolumnlump[i], width * sizeof(**texturecolumnlump));
+            index += width * sizeof(**texturecolumnlump);
+            memcpy(index, texturecolumnofs[i], width * sizeof(**texturecolumnofs));
+            index += width * sizeof(**texturecolumnofs);
+        }
+    }
 
     // Create translation table for global animation.
     texturetranslation = Z_Malloc((numtextures + 1) * sizeof(*texturetranslation), PU_STATIC, 0);
@@ -728,8 +786,8 @@ void R_InitFlats(void)
 {
     int i;
 
-    firstflat = W_GetNumForName("F_START") + 1;
-    lastflat = W_GetNumForName("F_END") - 1;
+    if (!W_GetNamespace(ns_flats, &firstflat, &lastflat))
+        I_Error("R_InitFlats: F_START and F_END not found!");
     numflats = lastflat - firstflat + 1;
 
     // Create translation table for global animation.
@@ -747,13 +805,15 @@ void R_InitFlats(void)
 //
 void R_InitSpriteLumps(void)
 {
-    int i;
+    int         i;
+    short       *index;
+    int         indexsize;
 
     for (i = 0; i < NUMMOBJTYPES; i++)
         mobjinfo[i].canmodify = true;
 
-    firstspritelump = W_GetNumForName("S_START") + 1;
-    lastspritelump = W_GetNumForName("S_END") - 1;
+    if (!W_GetNamespace(ns_sprites, &firstspritelump, &lastspritelump))
+        I_Error("R_InitSpriteLumps: S_START and S_END not found!");
 
     numspritelumps = lastspritelump - firstspritelump + 1;
     spritewidth = Z_Malloc(numspritelumps * sizeof(*spritewidth), PU_STATIC, 0);
@@ -761,39 +821,64 @@ void R_InitSpriteLumps(void)
     spriteoffset = Z_Malloc(numspritelumps * sizeof(*spriteoffset), PU_STATIC, 0);
     spritetopoffset = Z_Malloc(numspritelumps * sizeof(*spritetopoffset), PU_STATIC, 0);
 
-    for (i = 0; i < numspritelumps; i++)
+    // Each sprite's width, height, offsets and whether it was found, taken
+    //  from the lump index from the last launch if it's there, or from the
+    //  headers of the sprites themselves if not.
+    indexsize = numspritelumps * 5 * sizeof(*index);
+    if (!(index = W_GetIndexSection(INDEX_SPRITES, indexsize)))
     {
-        patch_t *patch = W_CacheLumpNum(firstspritelump + i, PU_CACHE);
+        index = W_NewIndexSection(INDEX_SPRITES, indexsize);
 
-        if (patch)
+        for (i = 0; i < numspritelumps; i++)
         {
-            spritewidth[i] = SHORT(patch->width) << FRACBITS;
-            spriteheight[i] = SHORT(patch->height) << FRACBITS;
-            spriteoffset[i] = SHORT(patch->leftoffset) << FRACBITS;
-            spritetopoffset[i] = SHORT(patch->topoffset) << FRACBITS;
+            patch_t     *patch = W_CacheLumpNum(firstspritelump + i, PU_CACHE);
+
+            if (patch)
+            {
+                index[i * 5] = SHORT(patch->width);
+                index[i * 5 + 1] = SHORT(patch->height);
+                index[i * 5 + 2] = SHORT(patch->leftoffset);
+                index[i * 5 + 3] = SHORT(patch->topoffset);
+                index[i * 5 + 4] = 1;
+            }
+        }
+    }
+
+    for (i = 0; i < numspritelumps; i++)
+        if (index[i * 5 + 4])
+        {
+            spritewidth[i] = index[i * 5] << FRACBITS;
+            spriteheight[i] = index[i * 5 + 1] << FRACBITS;
+            spriteoffset[i] = index[i * 5 + 2] << FRACBITS;
+            spritetopoffset[i] = index[i * 5 + 3] << FRACBITS;
+        }
 
-            // [BH] override sprite offsets in WAD with those in sproffsets[] in info.c
-            if (spritefixes && !FREEDOOM && !hacx)
+    // [BH] override sprite offsets in WAD with those in sproffsets[] in info.c
+    //  (looking up each of them once, rather than once for every sprite)
+    if (spritefixes && !FREEDOOM && !hacx)
+    {
+        boolean *fixed = calloc(numspritelumps, sizeof(*fixed));
+        int     j = 0;
+
+        while (sproffsets[j].name[0])
+        {
+            if (sproffsets[j].canmodify || BTSX)
             {
-                int j = 0;
+                i = W_CheckNumForName(sproffsets[j].name) - firstspritelump;
 
-                while (sproffsets[j].name[0])
+                if (i >= 0 && i < numspritelumps && index[i * 5 + 4] && !fixed[i])
                 {
-                    if (sproffsets[j].canmodify || BTSX)
-                    {
-                        if (i == W_CheckNumForName(sproffsets[j].name) - firstspritelump)
-                        {
-                            spriteoffset[i] = SHORT(sproffsets[j].x) << FRACBITS;
-                            spritetopoffset[i] = SHORT(sproffsets[j].y) << FRACBITS;
-                            break;
-                        }
-                    }
-                    else
-                        mobjinfo[sproffsets[j].type].canmodify = false;
-                    j++;
+                    spriteoffset[i] = SHORT(sproffsets[j].x) << FRACBITS;
+                    spritetopoffset[i] = SHORT(sproffsets[j].y) << FRACBITS;
+                    fixed[i] = true;
                 }
             }
+            else
+                mobjinfo[sproffsets[j].type].canmodify = false;
+            j++;
         }
+
+        free(fixed);
     }
 
     if (FREEDOOM)
@@ -923,10 +1008,12 @@ int R_ColormapNumForName(char *name)
 //
 void R_InitData(void)
 {
+    W_LoadIndex();
     R_InitTextures();
     R_InitFlats();
     R_InitSpriteLumps();
     R_InitColormaps();
+    W_SaveIndex();
 }
 
 //
@@ -950,13 +1037,9 @@ int R_FlatNumForName(char *name)
 //
 int R_CheckFlatNumForName(char *name)
 {
-    int  i;
-
-    for (i = firstflat; i <= lastflat; i++)
-        if (!strncasecmp(lumpinfo[i].name, name, 8))
-            return (i - firstflat);
+    int  i = W_CheckNumForNameInNamespace(name, ns_flats);
 
-    return -1;
+    return (i >= 0 ? i - firstflat : -1);
 }
 
 //
@@ -1002,6 +1085,64 @@ int R_TextureNumForName(char *name)
     return i;
 }
 
+//
+// R_PrefetchLevel
+// Hint that the flats and wall patches the level uses will soon be cached
+//  by R_PrecacheLevel, so they can be read from disk while the rest of the
+//  level is set up.
+//
+void R_PrefetchLevel(void)
+{
+    char        *present;
+    int         i;
+    int         j;
+
+    // Prefetch flats, which are next to each other in the WAD.
+    present = Z_Malloc(numflats, PU_STATIC, NULL);
+    memset(present, 0, numflats);
+
+    for (i = 0; i < numsectors; i++)
+    {
+        present[sectors[i].floorpic] = 1;
+        present[sectors[i].ceilingpic] = 1;
+    }
+
+    for (i = 0; i < numflats; i = j)
+    {
+        if (!present[i])
+        {
+            j = i + 1;
+            continue;
+        }
+
+        for (j = i + 1; j < numflats && present[j]; j++);
+
+        W_PrefetchLumps(firstflat + i, j - i);
+    }
+
+    Z_Free(present);
+
+    // Prefetch the patches of the textures on sidedefs, and the sky.
+    present = Z_Malloc(numtextures, PU_STATIC, NULL);
+    memset(present, 0, numtextures);
+
+    for (i = 0; i < numsides; i++)
+    {
+        present[sides[i].toptexture] = 1;
+        present[sides[i].midtexture] = 1;
+        present[sides[i].bottomtexture] = 1;
+    }
+
+    present[skytexture] = 1;
+
+    for (i = 0; i < numtextures; i++)
+        if (present[i])
+            for (j = 0; j < textures[i]->patchcount; j++)
+                W_PrefetchLumps(textures[i]->patches[j].patch, 1);
+
+    Z_Free(present);
+}
+
 //
 // R_PrecacheLevel
 // Preloads all relevant graphics for the level.
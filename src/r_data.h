@@ -127,6 +127,7 @@ byte *R_GetColumn(int tex, int col);
 
 // I/O, setting up the stuff.
 void R_InitData(void);
+void R_PrefetchLevel(void);
 void R_PrecacheLevel(void);
 
 // Retrieval.
@@ -128,9 +128,6 @@ typedef struct
     int                 linecount;
     struct line_s       **lines;                // [linecount] size
 
-    int                 cachedheight;
-    int                 scaleindex;
-
     int                 animate;
 
     // [AM] Previous position of floor and ceiling before
@@ -858,7 +855,7 @@ typedef struct vissprite_s
 
     mobjtype_t          type;
 
-    void                (*colfunc)(void);
+    void                (*colfunc)(colcontext_t *);
 
     // foot clipping
     fixed_t             footclip;
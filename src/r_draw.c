@@ -38,6 +38,9 @@
 
 #include "c_console.h"
 #include "doomstat.h"
+#include "i_system.h"
+#include "i_timer.h"
+#include "m_config.h"
 #include "m_random.h"
 #include "r_local.h"
 #include "st_stuff.h"
@@ -45,6 +48,10 @@
 #include "w_wad.h"
 #include "z_zone.h"
 
+#if defined(X86_CPU)
+#include <immintrin.h>
+#endif
+
 //
 // All drawing to the view buffer is accomplished in this file.
 // The other refresh files only know about ccordinates,
@@ -57,12 +64,25 @@
 int     viewwidth;
 int     scaledviewwidth;
 int     viewheight;
+int     scaledviewheight;
 int     viewheight2;
 int     viewwindowx;
 int     viewwindowy;
 int     fuzztable[SCREENWIDTH * SCREENHEIGHT];
 
+// The buffer the drawers write the player's view into, and how far apart
+//  vertically and horizontally adjacent pixels are within it.
+byte    *viewbuffer;
+int     viewpitch = SCREENWIDTH;
+int     viewxstep = 1;
+
+// Column-major view buffer, allocated when r_columnmajor is first used.
+static byte     *columnbuffer;
+
 extern int      screensize;
+extern int      graphicdetail;
+extern int      pixelwidth;
+extern int      pixelheight;
 
 // Color tables for different players,
 //  translate a limited part to another
@@ -154,22 +174,6 @@ byte megasphere[] =
 // R_DrawColumn
 // Source is the top of the column to scale.
 //
-lighttable_t    *dc_colormap;
-int             dc_x;
-int             dc_yl;
-int             dc_yh;
-fixed_t         dc_iscale;
-fixed_t         dc_texturemid;
-fixed_t         dc_texheight;
-fixed_t         dc_texturefrac;
-boolean         dc_topsparkle;
-boolean         dc_bottomsparkle;
-fixed_t         dc_blood;
-byte            *dc_colormask;
-int             dc_baseclip;
-
-// first pixel in a column (possibly virtual)
-byte            *dc_source;
 
 //
 // A column is a vertical slice/span from a wall texture that,
@@ -179,117 +183,134 @@ byte            *dc_source;
 //  be used. It has also been used with Wolfenstein 3D.
 //
 
-void R_DrawColumn(void)
+void R_DrawColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = colormap[source[frac >> FRACBITS]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = colormap[source[frac >> FRACBITS]];
 }
 
-void R_DrawShadowColumn(void)
+void R_DrawShadowColumn(colcontext_t *dc)
 {
-    int32_t     count = dc_yh - dc_yl + 1;
-    byte        *dest = R_ADDRESS(0, dc_x, dc_yl);
+    int32_t     count = dc->yh - dc->yl + 1;
+    byte        *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int   pitch = viewpitch;
 
     if (--count)
     {
         *dest = tinttab25[*dest];
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
     while (--count > 0)
     {
         *dest = tinttab40[*dest];
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
     *dest = tinttab25[*dest];
 }
 
-void R_DrawSpectreShadowColumn(void)
+// Each render thread keeps its own seed for the random flicker of fuzz and
+//  spectre shadows, rather than sharing rand()'s.
+static THREADLOCAL unsigned int fuzzseed = 1;
+
+static __inline int R_FuzzRand(void)
 {
-    int32_t     count = dc_yh - dc_yl + 1;
-    byte        *dest = R_ADDRESS(0, dc_x, dc_yl);
+    fuzzseed = fuzzseed * 1103515245 + 12345;
+    return ((fuzzseed >> 16) & 0x7FFF);
+}
+
+void R_DrawSpectreShadowColumn(colcontext_t *dc)
+{
+    int32_t     count = dc->yh - dc->yl + 1;
+    byte        *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int   pitch = viewpitch;
 
     if (--count)
     {
-        if (!(rand() % 4) && !consoleactive)
+        if (!(R_FuzzRand() % 4) && !consoleactive)
             *dest = tinttab25[*dest];
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
     while (--count > 0)
     {
         *dest = tinttab25[*dest];
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
-    if (!(rand() % 4) && !consoleactive)
+    if (!(R_FuzzRand() % 4) && !consoleactive)
         *dest = tinttab25[*dest];
 }
 
-void R_DrawSolidShadowColumn(void)
+void R_DrawSolidShadowColumn(colcontext_t *dc)
 {
-    int32_t     count = dc_yh - dc_yl + 1;
-    byte        *dest = R_ADDRESS(0, dc_x, dc_yl);
+    int32_t     count = dc->yh - dc->yl + 1;
+    byte        *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int   pitch = viewpitch;
 
     while (--count > 0)
     {
         *dest = 0;
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
     *dest = 0;
 }
 
-void R_DrawBloodSplatColumn(void)
+void R_DrawBloodSplatColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    const fixed_t       blood = dc_blood;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    const fixed_t       blood = dc->blood;
 
     while (--count > 0)
     {
         *dest = tinttab75[*dest + blood];
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
     *dest = tinttab75[*dest + blood];
 }
 
-void R_DrawSolidBloodSplatColumn(void)
+void R_DrawSolidBloodSplatColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    const fixed_t       blood = dc_blood;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    const fixed_t       blood = dc->blood;
 
     while (--count > 0)
     {
         *dest = blood >> 8;
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
     *dest = blood >> 8;
 }
 
-void R_DrawWallColumn(void)
+void R_DrawWallColumn(colcontext_t *dc)
 {
-    int32_t     count = dc_yh - dc_yl + 1;
+    int32_t     count = dc->yh - dc->yl + 1;
 
     if (count <= 0)
         return;
     else
     {
-        byte                    *dest = R_ADDRESS(0, dc_x, dc_yl);
-        const fixed_t           fracstep = dc_iscale;
-        fixed_t                 frac = dc_texturemid + (dc_yl - centery) * fracstep;
-        const byte              *source = dc_source;
-        const lighttable_t      *colormap = dc_colormap;
-        const fixed_t           texheight = dc_texheight;
+        byte                    *dest = R_VIEWADDRESS(dc->x, dc->yl);
+        const int               pitch = viewpitch;
+        const fixed_t           fracstep = dc->iscale;
+        fixed_t                 frac = dc->texturemid + (dc->yl - centery) * fracstep;
+        const byte              *source = dc->source;
+        const lighttable_t      *colormap = dc->colormap;
+        const fixed_t           texheight = dc->texheight;
         fixed_t                 heightmask = texheight - 1;
 
         // [SL] Properly tile textures whose heights are not a power-of-2,
@@ -308,7 +329,7 @@ void R_DrawWallColumn(void)
             while (count--)
             {
                 *dest = colormap[source[frac >> FRACBITS]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 if ((frac += fracstep) >= heightmask)
                     frac -= heightmask;
             }
@@ -320,28 +341,28 @@ void R_DrawWallColumn(void)
             while (count >= 8)
             {
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 count -= 8;
             }
@@ -349,63 +370,64 @@ void R_DrawWallColumn(void)
             if (count & 1)
             {
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
             }
 
             if (count & 2)
             {
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
             }
 
             if (count & 4)
             {
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
             }
         }
 
-        if (dc_bottomsparkle && !(((frac - fracstep) >> FRACBITS) & 2))
-            *(dest - SCREENWIDTH) = *(dest - SCREENWIDTH * 2);
+        if (dc->bottomsparkle && !(((frac - fracstep) >> FRACBITS) & 2))
+            *(dest - pitch) = *(dest - pitch * 2);
 
-        if (dc_topsparkle)
+        if (dc->topsparkle)
         {
-            dest = R_ADDRESS(0, dc_x, dc_yl);
-            *dest = *(dest + SCREENWIDTH);
+            dest = R_VIEWADDRESS(dc->x, dc->yl);
+            *dest = *(dest + pitch);
         }
     }
 }
 
-void R_DrawFullbrightWallColumn(void)
+void R_DrawFullbrightWallColumn(colcontext_t *dc)
 {
-    int32_t     count = dc_yh - dc_yl + 1;
+    int32_t     count = dc->yh - dc->yl + 1;
 
     if (count <= 0)
         return;
     else
     {
-        byte                    *dest = R_ADDRESS(0, dc_x, dc_yl);
-        const fixed_t           fracstep = dc_iscale;
-        fixed_t                 frac = dc_texturemid + (dc_yl - centery) * fracstep;
-        const byte              *source = dc_source;
-        const byte              *colormask = dc_colormask;
-        const lighttable_t      *colormap = dc_colormap;
-        const fixed_t           texheight = dc_texheight;
+        byte                    *dest = R_VIEWADDRESS(dc->x, dc->yl);
+        const int               pitch = viewpitch;
+        const fixed_t           fracstep = dc->iscale;
+        fixed_t                 frac = dc->texturemid + (dc->yl - centery) * fracstep;
+        const byte              *source = dc->source;
+        const byte              *colormask = dc->colormask;
+        const lighttable_t      *colormap = dc->colormap;
+        const fixed_t           texheight = dc->texheight;
         fixed_t                 heightmask = texheight - 1;
         byte                    dot;
 
@@ -426,7 +448,7 @@ void R_DrawFullbrightWallColumn(void)
             {
                 dot = source[frac >> FRACBITS];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 if ((frac += fracstep) >= heightmask)
                     frac -= heightmask;
             }
@@ -439,35 +461,35 @@ void R_DrawFullbrightWallColumn(void)
             {
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 count -= 8;
             }
@@ -476,7 +498,7 @@ void R_DrawFullbrightWallColumn(void)
             {
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
             }
 
@@ -484,11 +506,11 @@ void R_DrawFullbrightWallColumn(void)
             {
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
             }
 
@@ -496,58 +518,59 @@ void R_DrawFullbrightWallColumn(void)
             {
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
                 dot = source[(frac >> FRACBITS) & heightmask];
                 *dest = (colormask[dot] ? dot : colormap[dot]);
-                dest += SCREENWIDTH;
+                dest += pitch;
                 frac += fracstep;
             }
         }
 
-        if (dc_bottomsparkle && !(((frac - fracstep) >> FRACBITS) & 2))
-            *(dest - SCREENWIDTH) = *(dest - SCREENWIDTH * 2);
+        if (dc->bottomsparkle && !(((frac - fracstep) >> FRACBITS) & 2))
+            *(dest - pitch) = *(dest - pitch * 2);
 
-        if (dc_topsparkle)
+        if (dc->topsparkle)
         {
-            dest = R_ADDRESS(0, dc_x, dc_yl);
-            *dest = *(dest + SCREENWIDTH);
+            dest = R_VIEWADDRESS(dc->x, dc->yl);
+            *dest = *(dest + pitch);
         }
     }
 }
 
-void R_DrawPlayerSpriteColumn(void)
+void R_DrawPlayerSpriteColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(1, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_ADDRESS(1, dc->x, dc->yl);
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
 
     while (--count)
     {
-        *dest = dc_source[frac >> FRACBITS];
+        *dest = dc->source[frac >> FRACBITS];
         dest += SCREENWIDTH;
         frac += fracstep;
     }
-    *dest = dc_source[frac >> FRACBITS];
+    *dest = dc->source[frac >> FRACBITS];
 }
 
-void R_DrawSuperShotgunColumn(void)
+void R_DrawSuperShotgunColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
@@ -555,65 +578,67 @@ void R_DrawSuperShotgunColumn(void)
 
         if (dot != 71)
             *dest = colormap[tinttabredwhite[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = colormap[tinttabredwhite[(*dest << 8) + source[frac >> FRACBITS]]];
 }
 
-void R_DrawSkyColumn(void)
+void R_DrawSkyColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl;
+    int32_t             count = dc->yh - dc->yl;
     byte                *dest;
+    const int           pitch = viewpitch;
     fixed_t             frac;
-    const fixed_t       fracstep = dc_iscale;
+    const fixed_t       fracstep = dc->iscale;
 
     if (count++ < 0)
         return;
 
-    dest = R_ADDRESS(0, dc_x, dc_yl);
+    dest = R_VIEWADDRESS(dc->x, dc->yl);
 
-    frac = dc_texturemid + (dc_yl - centery) * fracstep;
+    frac = dc->texturemid + (dc->yl - centery) * fracstep;
 
     {
-        const byte              *source = dc_source;
-        const lighttable_t      *colormap = dc_colormap;
-        const fixed_t           heightmask = dc_texheight - 1;
+        const byte              *source = dc->source;
+        const lighttable_t      *colormap = dc->colormap;
+        const fixed_t           heightmask = dc->texheight - 1;
 
         while (--count)
         {
             *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
+            dest += pitch;
             frac += fracstep;
         }
         *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
     }
 }
 
-void R_DrawFlippedSkyColumn(void)
+void R_DrawFlippedSkyColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl;
+    int32_t             count = dc->yh - dc->yl;
     byte                *dest;
+    const int           pitch = viewpitch;
     fixed_t             frac;
-    const fixed_t       fracstep = dc_iscale;
+    const fixed_t       fracstep = dc->iscale;
 
     if (count++ < 0)
         return;
 
-    dest = R_ADDRESS(0, dc_x, dc_yl);
+    dest = R_VIEWADDRESS(dc->x, dc->yl);
 
-    frac = dc_texturemid + (dc_yl - centery) * fracstep;
+    frac = dc->texturemid + (dc->yl - centery) * fracstep;
 
     {
         fixed_t                 i;
-        const byte              *source = dc_source;
-        const lighttable_t      *colormap = dc_colormap;
+        const byte              *source = dc->source;
+        const lighttable_t      *colormap = dc->colormap;
 
         while (--count)
         {
             i = frac >> FRACBITS;
             *dest = colormap[source[i > 127 ? 126 - (i & 127) : i]];
-            dest += SCREENWIDTH;
+            dest += pitch;
             frac += fracstep;
         }
         i = frac >> FRACBITS;
@@ -621,307 +646,324 @@ void R_DrawFlippedSkyColumn(void)
     }
 }
 
-void R_DrawRedToBlueColumn(void)
+void R_DrawRedToBlueColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = colormap[redtoblue[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = colormap[redtoblue[source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucentRedToBlue33Column(void)
+void R_DrawTranslucentRedToBlue33Column(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = tinttab33[(*dest << 8) + colormap[redtoblue[source[frac >> FRACBITS]]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = tinttab33[(*dest << 8) + colormap[redtoblue[source[frac >> FRACBITS]]]];
 }
 
-void R_DrawRedToGreenColumn(void)
+void R_DrawRedToGreenColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = colormap[redtogreen[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = colormap[redtogreen[source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucentRedToGreen33Column(void)
+void R_DrawTranslucentRedToGreen33Column(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = tinttab33[(*dest << 8) + colormap[redtogreen[source[frac >> FRACBITS]]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = tinttab33[(*dest << 8) + colormap[redtogreen[source[frac >> FRACBITS]]]];
 }
 
-void R_DrawTranslucentColumn(void)
+void R_DrawTranslucentColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = tinttab[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = tinttab[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucent50Column(void)
+void R_DrawTranslucent50Column(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = tinttab50[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = tinttab50[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucent33Column(void)
+void R_DrawTranslucent33Column(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = tinttab33[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = tinttab33[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
 }
 
-void R_DrawMegaSphereColumn(void)
+void R_DrawMegaSphereColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = tinttab33[(*dest << 8) + colormap[megasphere[source[frac >> FRACBITS]]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = tinttab33[(*dest << 8) + colormap[megasphere[source[frac >> FRACBITS]]]];
 }
 
-void R_DrawSolidMegaSphereColumn(void)
+void R_DrawSolidMegaSphereColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = colormap[megasphere[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = colormap[megasphere[source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucentRedColumn(void)
+void R_DrawTranslucentRedColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = tinttabred[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = tinttabred[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucentRedWhiteColumn(void)
+void R_DrawTranslucentRedWhiteColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
     
     while (--count)
     {
         *dest = colormap[tinttabredwhite[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = colormap[tinttabredwhite[(*dest << 8) + source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucentRedWhite50Column(void)
+void R_DrawTranslucentRedWhite50Column(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = colormap[tinttabredwhite50[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = colormap[tinttabredwhite50[(*dest << 8) + source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucentGreenColumn(void)
+void R_DrawTranslucentGreenColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = tinttabgreen[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = tinttabgreen[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucentBlueColumn(void)
+void R_DrawTranslucentBlueColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = tinttabblue[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = tinttabblue[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucentRed50Column(void)
+void R_DrawTranslucentRed50Column(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = colormap[tinttabred50[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = colormap[tinttabred50[(*dest << 8) + source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucentGreen50Column(void)
+void R_DrawTranslucentGreen50Column(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = colormap[tinttabgreen50[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = colormap[tinttabgreen50[(*dest << 8) + source[frac >> FRACBITS]]];
 }
 
-void R_DrawTranslucentBlue50Column(void)
+void R_DrawTranslucentBlue50Column(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
 
     while (--count)
     {
         *dest = colormap[tinttabblue50[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = colormap[tinttabblue50[(*dest << 8) + source[frac >> FRACBITS]]];
@@ -930,74 +972,81 @@ void R_DrawTranslucentBlue50Column(void)
 //
 // Spectre/Invisibility.
 //
-extern int      fuzzpos;
-
-int             fuzzrange[3] = { -SCREENWIDTH, 0, SCREENWIDTH };
-
-#define FUZZ(a, b)      fuzzrange[rand() % (b - a + 1) + a]
+// fuzztable holds the direction (-1 = up, 0, 1 = down) each fuzzy pixel was
+//  taken from, so it can be redrawn the same way while paused. Sprites in the
+//  view index it by column and row, so render threads never share an entry.
+#define FUZZ(a, b)      (R_FuzzRand() % (b - a + 1) + a - 1)
 #define NOFUZZ          251
 
-void R_DrawFuzzColumn(void)
+void R_DrawFuzzColumn(colcontext_t *dc)
 {
     byte        *dest;
-    int         count = dc_yh - dc_yl;
+    int         *fuzz;
+    const int   pitch = viewpitch;
+    int         count = dc->yh - dc->yl;
 
     if (count < 0)
         return;
 
-    dest = R_ADDRESS(0, dc_x, dc_yl);
+    dest = R_VIEWADDRESS(dc->x, dc->yl);
+    fuzz = fuzztable + dc->x * SCREENHEIGHT + dc->yl;
 
     if (count)
     {
         // top
-        if (!dc_yl)
-            *dest = fullcolormap[6 * 256 + dest[(fuzztable[fuzzpos++] = FUZZ(1, 2))]];
-        else if (!(rand() % 4))
-            *dest = fullcolormap[12 * 256 + dest[(fuzztable[fuzzpos++] = FUZZ(0, 2))]];
-        dest += SCREENWIDTH;
+        if (!dc->yl)
+            *dest = fullcolormap[6 * 256 + dest[(*fuzz = FUZZ(1, 2)) * pitch]];
+        else if (!(R_FuzzRand() % 4))
+            *dest = fullcolormap[12 * 256 + dest[(*fuzz = FUZZ(0, 2)) * pitch]];
+        dest += pitch;
+        fuzz++;
 
         while (--count)
         {
             // middle
-            *dest = fullcolormap[6 * 256 + dest[(fuzztable[fuzzpos++] = FUZZ(0, 2))]];
-            dest += SCREENWIDTH;
+            *dest = fullcolormap[6 * 256 + dest[(*fuzz++ = FUZZ(0, 2)) * pitch]];
+            dest += pitch;
         }
 
         // bottom
-        if (dc_yh == viewheight - 1)
-            *dest = fullcolormap[5 * 256 + dest[(fuzztable[fuzzpos] = FUZZ(0, 1))]];
-        else if (dc_baseclip == -1 && !(rand() % 4))
-            *dest = fullcolormap[14 * 256 + dest[(fuzztable[fuzzpos] = FUZZ(0, 1))]];
+        if (dc->yh == viewheight - 1)
+            *dest = fullcolormap[5 * 256 + dest[(*fuzz = FUZZ(0, 1)) * pitch]];
+        else if (dc->baseclip == -1 && !(R_FuzzRand() % 4))
+            *dest = fullcolormap[14 * 256 + dest[(*fuzz = FUZZ(0, 1)) * pitch]];
     }
 }
 
-void R_DrawPausedFuzzColumn(void)
+void R_DrawPausedFuzzColumn(colcontext_t *dc)
 {
     byte        *dest;
-    int         count = dc_yh - dc_yl;
+    int         *fuzz;
+    const int   pitch = viewpitch;
+    int         count = dc->yh - dc->yl;
 
     if (count < 0)
         return;
 
-    dest = R_ADDRESS(0, dc_x, dc_yl);
+    dest = R_VIEWADDRESS(dc->x, dc->yl);
+    fuzz = fuzztable + dc->x * SCREENHEIGHT + dc->yl;
 
     if (count)
     {
         // top
-        if (!dc_yl)
-            *dest = fullcolormap[6 * 256 + dest[fuzztable[fuzzpos++]]];
-        dest += SCREENWIDTH;
+        if (!dc->yl)
+            *dest = fullcolormap[6 * 256 + dest[*fuzz * pitch]];
+        dest += pitch;
+        fuzz++;
 
         while (--count)
         {
             // middle
-            *dest = fullcolormap[6 * 256 + dest[fuzztable[fuzzpos++]]];
-            dest += SCREENWIDTH;
+            *dest = fullcolormap[6 * 256 + dest[*fuzz++ * pitch]];
+            dest += pitch;
         }
 
         // bottom
-        if (dc_yh == viewheight - 1)
-            *dest = fullcolormap[5 * 256 + dest[fuzztable[fuzzpos]]];
+        if (dc->yh == viewheight - 1)
+            *dest = fullcolormap[5 * 256 + dest[*fuzz * pitch]];
     }
 }
 
@@ -1020,30 +1069,30 @@ void R_DrawFuzzColumns(void)
                 if (!y || *(src - SCREENWIDTH) == NOFUZZ)
                 {
                     // top
-                    if (!(rand() % 4))
-                        *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2))]];
+                    if (!(R_FuzzRand() % 4))
+                        *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2)) * SCREENWIDTH]];
                 }
                 else if (y == h - SCREENWIDTH)
                 {
                     // bottom of view
-                    *dest = fullcolormap[5 * 256 + dest[(fuzztable[i] = FUZZ(0, 1))]];
+                    *dest = fullcolormap[5 * 256 + dest[(fuzztable[i] = FUZZ(0, 1)) * SCREENWIDTH]];
                 }
                 else if (*(src + SCREENWIDTH) == NOFUZZ)
                 {
                     // bottom of post
-                    if (!(rand() % 4))
-                        *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2))]];
+                    if (!(R_FuzzRand() % 4))
+                        *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2)) * SCREENWIDTH]];
                 }
                 else
                 {
                     // middle
                     if (*(src - 1) == NOFUZZ || *(src + 1) == NOFUZZ)
                     {
-                        if (!(rand() % 4))
-                            *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2))]];
+                        if (!(R_FuzzRand() % 4))
+                            *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2)) * SCREENWIDTH]];
                     }
                     else
-                        *dest = fullcolormap[6 * 256 + dest[(fuzztable[i] = FUZZ(0, 2))]];
+                        *dest = fullcolormap[6 * 256 + dest[(fuzztable[i] = FUZZ(0, 2)) * SCREENWIDTH]];
                 }
             }
         }
@@ -1073,7 +1122,7 @@ void R_DrawPausedFuzzColumns(void)
                 else if (y == h - SCREENWIDTH)
                 {
                     // bottom of view
-                    *dest = fullcolormap[5 * 256 + dest[fuzztable[i]]];
+                    *dest = fullcolormap[5 * 256 + dest[fuzztable[i] * SCREENWIDTH]];
                 }
                 else if (*(src + SCREENWIDTH) == NOFUZZ)
                 {
@@ -1088,7 +1137,7 @@ void R_DrawPausedFuzzColumns(void)
                         // do nothing
                     }
                     else
-                        *dest = fullcolormap[6 * 256 + dest[fuzztable[i]]];
+                        *dest = fullcolormap[6 * 256 + dest[fuzztable[i] * SCREENWIDTH]];
                 }
             }
         }
@@ -1103,23 +1152,23 @@ void R_DrawPausedFuzzColumns(void)
 //  of the BaronOfHell, the HellKnight, uses
 //  identical sprites, kinda brightened up.
 //
-byte    *dc_translation;
 byte    *translationtables;
 
-void R_DrawTranslatedColumn(void)
+void R_DrawTranslatedColumn(colcontext_t *dc)
 {
-    int32_t             count = dc_yh - dc_yl + 1;
-    byte                *dest = R_ADDRESS(0, dc_x, dc_yl);
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translation = dc_translation;
+    int32_t             count = dc->yh - dc->yl + 1;
+    byte                *dest = R_VIEWADDRESS(dc->x, dc->yl);
+    const int           pitch = viewpitch;
+    fixed_t             frac = dc->texturefrac;
+    const fixed_t       fracstep = dc->iscale;
+    const byte          *source = dc->source;
+    const lighttable_t  *colormap = dc->colormap;
+    const byte          *translation = dc->translation;
 
     while (--count)
     {
         *dest = colormap[translation[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
     *dest = colormap[translation[source[frac >> FRACBITS]]];
@@ -1164,50 +1213,179 @@ void R_InitTranslationTables(void)
 // In consequence, flats are not stored by column (like walls),
 //  and the inner loop has to step in texture space u and v.
 //
-int             ds_y;
-int             ds_x1;
-int             ds_x2;
-
-lighttable_t    *ds_colormap;
-
-fixed_t         ds_xfrac;
-fixed_t         ds_yfrac;
-fixed_t         ds_xstep;
-fixed_t         ds_ystep;
-
-// start of a 64*64 tile image
-byte            *ds_source;
 
 //
 // Draws the actual span.
 //
-void R_DrawSpan(void)
+void R_DrawSpan(spancontext_t *ds)
 {
-    unsigned int        count = ds_x2 - ds_x1 + 1;
-    byte                *dest = R_ADDRESS(0, ds_x1, ds_y);
-    fixed_t             xfrac = ds_xfrac;
-    fixed_t             yfrac = ds_yfrac;
-    const fixed_t       xstep = ds_xstep;
-    const fixed_t       ystep = ds_ystep;
-    const byte          *source = ds_source;
-    const lighttable_t  *colormap = ds_colormap;
+    unsigned int        count = ds->x2 - ds->x1 + 1;
+    byte                *dest = R_VIEWADDRESS(ds->x1, ds->y);
+    const int           step = viewxstep;
+    fixed_t             xfrac = ds->xfrac;
+    fixed_t             yfrac = ds->yfrac;
+    const fixed_t       xstep = ds->xstep;
+    const fixed_t       ystep = ds->ystep;
+    const byte          *source = ds->source;
+    const lighttable_t  *colormap = ds->colormap;
 
     while (count >= 4)
     {
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += step;
         xfrac += xstep;
         yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += step;
         xfrac += xstep;
         yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += step;
         xfrac += xstep;
         yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += step;
         xfrac += xstep;
         yfrac += ystep;
         count -= 4;
     }
+    while (count-- > 0)
+    {
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += step;
+        xfrac += xstep;
+        yfrac += ystep;
+    }
+}
+
+#if defined(X86_CPU)
+//
+// R_DrawSpanSSE2
+// Same as R_DrawSpan, but works out the texel offsets of 16 pixels at a
+//  time. The flat and colormap lookups are still done one pixel at a time
+//  since SSE2 has no way to index a 256 byte table.
+//
+TARGET("sse2") void R_DrawSpanSSE2(spancontext_t *ds)
+{
+    unsigned int        count = ds->x2 - ds->x1 + 1;
+    byte                *dest = R_VIEWADDRESS(ds->x1, ds->y);
+    fixed_t             xfrac = ds->xfrac;
+    fixed_t             yfrac = ds->yfrac;
+    const fixed_t       xstep = ds->xstep;
+    const fixed_t       ystep = ds->ystep;
+    const byte          *source = ds->source;
+    const lighttable_t  *colormap = ds->colormap;
+
+    // spans run down a column of a transposed view buffer
+    if (viewxstep != 1)
+    {
+        R_DrawSpan(ds);
+        return;
+    }
+
+    if (count >= 16)
+    {
+        const __m128i   xmask = _mm_set1_epi32(63);
+        const __m128i   ymask = _mm_set1_epi32(4032);
+        const __m128i   xstep4 = _mm_set1_epi32(xstep * 4);
+        const __m128i   ystep4 = _mm_set1_epi32(ystep * 4);
+        __m128i         x = _mm_setr_epi32(xfrac, xfrac + xstep, xfrac + xstep * 2, xfrac + xstep * 3);
+        __m128i         y = _mm_setr_epi32(yfrac, yfrac + ystep, yfrac + ystep * 2, yfrac + ystep * 3);
+        ALIGN(16) int   spot[16];
+
+        do
+        {
+            int i;
+
+            for (i = 0; i < 16; i += 4)
+            {
+                _mm_store_si128((__m128i *)&spot[i],
+                    _mm_or_si128(_mm_and_si128(_mm_srli_epi32(x, 16), xmask),
+                    _mm_and_si128(_mm_srli_epi32(y, 10), ymask)));
+                x = _mm_add_epi32(x, xstep4);
+                y = _mm_add_epi32(y, ystep4);
+            }
+
+            for (i = 0; i < 16; i++)
+                dest[i] = colormap[source[spot[i]]];
+
+            dest += 16;
+            count -= 16;
+        } while (count >= 16);
+
+        xfrac = _mm_cvtsi128_si32(x);
+        yfrac = _mm_cvtsi128_si32(y);
+    }
+
+    while (count-- > 0)
+    {
+        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        xfrac += xstep;
+        yfrac += ystep;
+    }
+}
+
+//
+// R_DrawSpanAVX2
+// Same as R_DrawSpan, but draws 8 pixels at a time using gathers for both
+//  the flat and the colormap lookups. Each gather reads the 32 bits ending
+//  at the byte wanted, so it never reads past the end of the flat or the
+//  colormap, but does read up to 3 bytes before them.
+//
+TARGET("avx2") void R_DrawSpanAVX2(spancontext_t *ds)
+{
+    unsigned int        count = ds->x2 - ds->x1 + 1;
+    byte                *dest = R_VIEWADDRESS(ds->x1, ds->y);
+    fixed_t             xfrac = ds->xfrac;
+    fixed_t             yfrac = ds->yfrac;
+    const fixed_t       xstep = ds->xstep;
+    const fixed_t       ystep = ds->ystep;
+    const byte          *source = ds->source;
+    const lighttable_t  *colormap = ds->colormap;
+
+    if (viewxstep != 1)
+    {
+        R_DrawSpan(ds);
+        return;
+    }
+
+    if (count >= 8)
+    {
+        const __m256i   xmask = _mm256_set1_epi32(63);
+        const __m256i   ymask = _mm256_set1_epi32(4032);
+        const __m256i   xstep8 = _mm256_set1_epi32(xstep * 8);
+        const __m256i   ystep8 = _mm256_set1_epi32(ystep * 8);
+        const __m256i   lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i         x = _mm256_add_epi32(_mm256_set1_epi32(xfrac),
+                            _mm256_mullo_epi32(lanes, _mm256_set1_epi32(xstep)));
+        __m256i         y = _mm256_add_epi32(_mm256_set1_epi32(yfrac),
+                            _mm256_mullo_epi32(lanes, _mm256_set1_epi32(ystep)));
+
+        do
+        {
+            __m256i     spot = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(x, 16), xmask),
+                            _mm256_and_si256(_mm256_srli_epi32(y, 10), ymask));
+            __m256i     texel = _mm256_srli_epi32(_mm256_i32gather_epi32((const int *)(source - 3),
+                            spot, 1), 24);
+            __m256i     pixel = _mm256_srli_epi32(_mm256_i32gather_epi32((const int *)(colormap - 3),
+                            texel, 1), 24);
+
+            // pack the low byte of each lane into 8 bytes
+            pixel = _mm256_packus_epi32(pixel, pixel);
+            pixel = _mm256_packus_epi16(pixel, pixel);
+            _mm_storel_epi64((__m128i *)dest, _mm_unpacklo_epi32(_mm256_castsi256_si128(pixel),
+                _mm256_extracti128_si256(pixel, 1)));
+
+            x = _mm256_add_epi32(x, xstep8);
+            y = _mm256_add_epi32(y, ystep8);
+            dest += 8;
+            count -= 8;
+        } while (count >= 8);
+
+        xfrac = _mm_cvtsi128_si32(_mm256_castsi256_si128(x));
+        yfrac = _mm_cvtsi128_si32(_mm256_castsi256_si128(y));
+    }
+
     while (count-- > 0)
     {
         *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
@@ -1215,6 +1393,164 @@ void R_DrawSpan(void)
         yfrac += ystep;
     }
 }
+#endif
+
+//
+// R_SetViewBuffer
+// Points the drawers at either the view window of the screen or, if
+//  transposed, a column-major buffer where each column of the view is
+//  contiguous in memory. The column drawers then step one byte per pixel
+//  instead of a whole screen width, and the result is copied back to the
+//  screen with R_TransposeView.
+//
+void R_SetViewBuffer(boolean transposed)
+{
+    if (transposed)
+    {
+        if (!columnbuffer)
+            columnbuffer = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
+
+        viewbuffer = columnbuffer;
+        viewpitch = 1;
+        viewxstep = SCREENHEIGHT;
+    }
+    else
+    {
+        viewbuffer = screens[0] + viewwindowy * SCREENWIDTH + viewwindowx;
+        viewpitch = SCREENWIDTH;
+        viewxstep = 1;
+    }
+}
+
+//
+// R_FillViewBuffer
+//
+void R_FillViewBuffer(int color)
+{
+    if (viewxstep == 1)
+        V_FillRect(0, viewwindowx, viewwindowy, viewwidth, viewheight, color);
+    else
+    {
+        int     x;
+
+        for (x = 0; x < viewwidth; x++)
+            memset(viewbuffer + x * viewxstep, color, viewheight);
+    }
+}
+
+#if defined(X86_CPU)
+//
+// R_TransposeTileSSE2
+// Transposes a 16x16 tile of bytes. Each round interleaves rows i and i + 8,
+//  and after four rounds row i holds what was column i.
+//
+TARGET("sse2") static void R_TransposeTileSSE2(const byte *src, byte *dest)
+{
+    __m128i     a[16];
+    __m128i     b[16];
+    int         i;
+    int         round;
+
+    for (i = 0; i < 16; i++)
+        a[i] = _mm_loadu_si128((const __m128i *)(src + i * SCREENHEIGHT));
+
+    for (round = 0; round < 4; round++)
+    {
+        for (i = 0; i < 8; i++)
+        {
+            b[i * 2] = _mm_unpacklo_epi8(a[i], a[i + 8]);
+            b[i * 2 + 1] = _mm_unpackhi_epi8(a[i], a[i + 8]);
+        }
+        memcpy(a, b, sizeof(a));
+    }
+
+    for (i = 0; i < 16; i++)
+        _mm_storeu_si128((__m128i *)(dest + i * SCREENWIDTH), a[i]);
+}
+#endif
+
+//
+// R_TransposeView
+// Copies the column-major view buffer to the view window of the screen,
+//  16x16 pixels at a time so both buffers are read and written a cache
+//  line at a time.
+//
+void R_TransposeView(void)
+{
+    byte        *dest = screens[0] + viewwindowy * SCREENWIDTH + viewwindowx;
+    int         x, y;
+    int         w = viewwidth & ~15;
+    int         h = viewheight & ~15;
+
+#if defined(X86_CPU)
+    if (I_GetCPUFeatures() & CPU_SSE2)
+    {
+        for (x = 0; x < w; x += 16)
+            for (y = 0; y < h; y += 16)
+                R_TransposeTileSSE2(columnbuffer + x * SCREENHEIGHT + y, dest + y * SCREENWIDTH + x);
+    }
+    else
+#endif
+    {
+        for (x = 0; x < w; x += 16)
+            for (y = 0; y < h; y += 16)
+            {
+                int     i, j;
+
+                for (i = 0; i < 16; i++)
+                    for (j = 0; j < 16; j++)
+                        dest[(y + j) * SCREENWIDTH + x + i] = columnbuffer[(x + i) * SCREENHEIGHT + y + j];
+            }
+    }
+
+    // right and bottom edges that don't fill a whole tile
+    for (x = w; x < viewwidth; x++)
+        for (y = 0; y < viewheight; y++)
+            dest[y * SCREENWIDTH + x] = columnbuffer[x * SCREENHEIGHT + y];
+
+    for (x = 0; x < w; x++)
+        for (y = h; y < viewheight; y++)
+            dest[y * SCREENWIDTH + x] = columnbuffer[x * SCREENHEIGHT + y];
+}
+
+//
+// R_UpscaleView
+// Stretches a view rendered at less than the size of its window, in the
+//  top left corner of it, to fill the window. This is done in place from
+//  the bottom up, so each row is built from a row above it that hasn't
+//  been overwritten yet. When the graphic detail is low, each pixel fills
+//  exactly one pixelwidth x pixelheight block.
+//
+void R_UpscaleView(void)
+{
+    static int  xlookup[SCREENWIDTH];
+    static byte row[SCREENWIDTH];
+    byte        *dest = screens[0] + viewwindowy * SCREENWIDTH + viewwindowx;
+    int         x, y;
+    int         lastsy = -1;
+
+    for (x = 0; x < scaledviewwidth; x++)
+        xlookup[x] = (graphicdetail == LOW ? x / pixelwidth : x * viewwidth / scaledviewwidth);
+
+    for (y = scaledviewheight - 1; y >= 0; y--)
+    {
+        int     sy = (graphicdetail == LOW ? y / pixelheight : y * viewheight / scaledviewheight);
+        byte    *out = dest + y * SCREENWIDTH;
+
+        // same source row as the row below
+        if (sy == lastsy)
+            memcpy(out, out + SCREENWIDTH, scaledviewwidth);
+        else
+        {
+            byte        *src = dest + sy * SCREENWIDTH;
+
+            for (x = 0; x < scaledviewwidth; x++)
+                row[x] = src[xlookup[x]];
+            memcpy(out, row, scaledviewwidth);
+            lastsy = sy;
+        }
+    }
+}
 
 //
 // R_InitBuffer
@@ -1230,6 +1566,8 @@ void R_InitBuffer(int width, int height)
 
     // Same with base row offset.
     viewwindowy = (width == SCREENWIDTH ? 0 : (SCREENHEIGHT - SBARHEIGHT - height) >> 1);
+
+    R_SetViewBuffer(false);
 }
 
 //
@@ -1275,7 +1613,7 @@ void R_FillBackScreen(void)
 
     // Draw screen and bezel; this is done to a separate screen buffer.
     width = scaledviewwidth / 2;
-    height = viewheight / 2;
+    height = scaledviewheight / 2;
     windowx = viewwindowx / 2;
     windowy = viewwindowy / 2;
 
@@ -1298,6 +1636,10 @@ void R_FillBackScreen(void)
     V_DrawPatch(windowx + width, windowy - 8, 1, brdr_tr);
     V_DrawPatch(windowx - 8, windowy + height, 1, brdr_bl);
     V_DrawPatch(windowx + width, windowy + height, 1, brdr_br);
+
+    // the view itself is drawn at low detail by the renderer
+    if (graphicdetail == LOW)
+        V_LowGraphicDetail(1, viewheight2);
 }
 
 //
@@ -1328,23 +1670,124 @@ void R_DrawViewBorder(void)
     if (scaledviewwidth == SCREENWIDTH)
         return;
 
-    top = (SCREENHEIGHT - SBARHEIGHT - viewheight) / 2;
+    top = (SCREENHEIGHT - SBARHEIGHT - scaledviewheight) / 2;
     side = (SCREENWIDTH - scaledviewwidth) / 2;
 
     // copy top and one line of left side
     R_VideoErase(0, top * SCREENWIDTH + side);
 
     // copy one line of right side and bottom
-    ofs = (viewheight + top) * SCREENWIDTH - side;
+    ofs = (scaledviewheight + top) * SCREENWIDTH - side;
     R_VideoErase(ofs, top * SCREENWIDTH + side);
 
     // copy sides using wraparound
     ofs = top * SCREENWIDTH + SCREENWIDTH - side;
     side <<= 1;
 
-    for (i = 1; i < viewheight; i++)
+    for (i = 1; i < scaledviewheight; i++)
     {
         R_VideoErase(ofs, side);
         ofs += SCREENWIDTH;
     }
 }
+
+//
+// R_BenchmarkColumnDrawer
+// Draws every column of the view window with the given drawer, frames
+//  times over, and reports the average cost of a column.
+//
+static void R_BenchmarkColumnDrawer(char *name, void (*drawer)(colcontext_t *),
+    colcontext_t *dc, int frames)
+{
+    uint64_t    start = I_GetTimeUS();
+    int         i;
+
+    for (i = 0; i < frames; i++)
+        for (dc->x = 0; dc->x < viewwidth; dc->x++)
+            drawer(dc);
+
+    C_Output("%s: %.1f ns per %i pixel column.", name,
+        (I_GetTimeUS() - start) * 1000.0 / ((double)frames * viewwidth), viewheight);
+}
+
+//
+// R_BenchmarkSpanDrawer
+// Draws every row of the view window with the given drawer, frames
+//  times over, and reports the average cost of a span.
+//
+static void R_BenchmarkSpanDrawer(char *name, void (*drawer)(spancontext_t *),
+    spancontext_t *ds, int frames)
+{
+    uint64_t    start = I_GetTimeUS();
+    int         i;
+
+    for (i = 0; i < frames; i++)
+        for (ds->y = 0; ds->y < viewheight; ds->y++)
+            drawer(ds);
+
+    C_Output("%s: %.1f ns per %i pixel span.", name,
+        (I_GetTimeUS() - start) * 1000.0 / ((double)frames * viewheight), viewwidth);
+}
+
+//
+// R_BenchmarkDrawers
+// Times the column and span drawers that do the bulk of the work in a
+//  frame, using a test pattern instead of real textures and flats.
+//
+void R_BenchmarkDrawers(int frames)
+{
+    static byte         pattern[4 + 4096];
+    byte                *source = &pattern[4];
+    colcontext_t        dc;
+    spancontext_t       ds;
+    uint64_t            start;
+    int                 i;
+
+    for (i = 0; i < 4096; i++)
+        source[i] = i & 255;
+
+    memset(&dc, 0, sizeof(dc));
+    dc.yl = 0;
+    dc.yh = viewheight - 1;
+    dc.iscale = FRACUNIT / 2;
+    dc.texturemid = centery * dc.iscale;
+    dc.texheight = 128;
+    dc.colormap = fullcolormap;
+    dc.source = source;
+
+    R_SetViewBuffer(false);
+    R_BenchmarkColumnDrawer("R_DrawColumn", R_DrawColumn, &dc, frames);
+    R_BenchmarkColumnDrawer("R_DrawWallColumn", R_DrawWallColumn, &dc, frames);
+    R_BenchmarkColumnDrawer("R_DrawTranslucentColumn", R_DrawTranslucentColumn, &dc, frames);
+
+    R_SetViewBuffer(true);
+    R_BenchmarkColumnDrawer("R_DrawColumn (column-major)", R_DrawColumn, &dc, frames);
+    R_BenchmarkColumnDrawer("R_DrawWallColumn (column-major)", R_DrawWallColumn, &dc, frames);
+
+    start = I_GetTimeUS();
+    for (i = 0; i < frames; i++)
+        R_TransposeView();
+    C_Output("R_TransposeView: %.1f ns per %ix%i view.",
+        (I_GetTimeUS() - start) * 1000.0 / frames, viewwidth, viewheight);
+
+    R_SetViewBuffer(false);
+
+    ds.x1 = 0;
+    ds.x2 = viewwidth - 1;
+    ds.xfrac = 0;
+    ds.yfrac = 0;
+    ds.xstep = FRACUNIT / 2;
+    ds.ystep = FRACUNIT / 4;
+    ds.colormap = fullcolormap;
+    ds.source = source;
+
+    R_BenchmarkSpanDrawer("R_DrawSpan", R_DrawSpan, &ds, frames);
+
+#if defined(X86_CPU)
+    if (I_GetCPUFeatures() & CPU_SSE2)
+        R_BenchmarkSpanDrawer("R_DrawSpanSSE2", R_DrawSpanSSE2, &ds, frames);
+
+    if (I_GetCPUFeatures() & CPU_AVX2)
+        R_BenchmarkSpanDrawer("R_DrawSpanAVX2", R_DrawSpanAVX2, &ds, frames);
+#endif
+}
@@ -42,22 +42,52 @@
 #define R_ADDRESS(scrn, px, py) \
     (screens[scrn] + (viewwindowy + (py)) * SCREENWIDTH + (viewwindowx + (px)))
 
-extern lighttable_t     *dc_colormap;
-extern int              dc_x;
-extern int              dc_yl;
-extern int              dc_yh;
-extern fixed_t          dc_iscale;
-extern fixed_t          dc_texturemid;
-extern fixed_t          dc_texheight;
-extern fixed_t          dc_texturefrac;
-extern boolean          dc_topsparkle;
-extern boolean          dc_bottomsparkle;
-extern fixed_t          dc_blood;
-extern byte             *dc_colormask;
-extern int              dc_baseclip;
-
-// first pixel in a column
-extern byte             *dc_source;
+#define R_VIEWADDRESS(px, py)   (viewbuffer + (py) * viewpitch + (px) * viewxstep)
+
+// Everything a column drawer needs to draw one column,
+//  filled in by the caller and passed to colfunc.
+struct colcontext_s
+{
+    int                 x;
+    int                 yl;
+    int                 yh;
+    fixed_t             iscale;
+    fixed_t             texturemid;
+    fixed_t             texheight;
+    fixed_t             texturefrac;
+    lighttable_t        *colormap;
+
+    // first pixel in a column
+    byte                *source;
+
+    byte                *translation;
+    byte                *colormask;
+    boolean             topsparkle;
+    boolean             bottomsparkle;
+    fixed_t             blood;
+    int                 baseclip;
+};
+
+// Everything a span drawer needs to draw one span,
+//  filled in by R_MapPlane and passed to spanfunc.
+typedef struct
+{
+    int                 y;
+    int                 x1;
+    int                 x2;
+    fixed_t             xfrac;
+    fixed_t             yfrac;
+    fixed_t             xstep;
+    fixed_t             ystep;
+    lighttable_t        *colormap;
+
+    // start of a 64*64 tile image
+    byte                *source;
+} spancontext_t;
+
+extern byte             *viewbuffer;
+extern int              viewpitch;
+extern int              viewxstep;
 
 extern byte             *tinttab;
 extern byte             *tinttab25;
@@ -77,72 +107,68 @@ extern byte             *tinttabblue50;
 // The span blitting interface.
 // Hook in assembler or system specific BLT
 //  here.
-void R_DrawColumn(void);
-void R_DrawWallColumn(void);
-void R_DrawFullbrightWallColumn(void);
-void R_DrawSkyColumn(void);
-void R_DrawFlippedSkyColumn(void);
-void R_DrawTranslucentColumn(void);
-void R_DrawTranslucent50Column(void);
-void R_DrawTranslucent33Column(void);
-void R_DrawTranslucentGreenColumn(void);
-void R_DrawTranslucentRedColumn(void);
-void R_DrawTranslucentRedWhiteColumn(void);
-void R_DrawTranslucentRedWhite50Column(void);
-void R_DrawTranslucentBlueColumn(void);
-void R_DrawTranslucentGreen50Column(void);
-void R_DrawTranslucentRed50Column(void);
-void R_DrawTranslucentBlue50Column(void);
-void R_DrawRedToBlueColumn(void);
-void R_DrawTranslucentRedToBlue33Column(void);
-void R_DrawRedToGreenColumn(void);
-void R_DrawTranslucentRedToGreen33Column(void);
-void R_DrawPlayerSpriteColumn(void);
-void R_DrawSuperShotgunColumn(void);
-void R_DrawShadowColumn(void);
-void R_DrawSpectreShadowColumn(void);
-void R_DrawSolidShadowColumn(void);
-void R_DrawBloodSplatColumn(void);
-void R_DrawSolidBloodSplatColumn(void);
-void R_DrawMegaSphereColumn(void);
-void R_DrawSolidMegaSphereColumn(void);
+void R_DrawColumn(colcontext_t *dc);
+void R_DrawWallColumn(colcontext_t *dc);
+void R_DrawFullbrightWallColumn(colcontext_t *dc);
+void R_DrawSkyColumn(colcontext_t *dc);
+void R_DrawFlippedSkyColumn(colcontext_t *dc);
+void R_DrawTranslucentColumn(colcontext_t *dc);
+void R_DrawTranslucent50Column(colcontext_t *dc);
+void R_DrawTranslucent33Column(colcontext_t *dc);
+void R_DrawTranslucentGreenColumn(colcontext_t *dc);
+void R_DrawTranslucentRedColumn(colcontext_t *dc);
+void R_DrawTranslucentRedWhiteColumn(colcontext_t *dc);
+void R_DrawTranslucentRedWhite50Column(colcontext_t *dc);
+void R_DrawTranslucentBlueColumn(colcontext_t *dc);
+void R_DrawTranslucentGreen50Column(colcontext_t *dc);
+void R_DrawTranslucentRed50Column(colcontext_t *dc);
+void R_DrawTranslucentBlue50Column(colcontext_t *dc);
+void R_DrawRedToBlueColumn(colcontext_t *dc);
+void R_DrawTranslucentRedToBlue33Column(colcontext_t *dc);
+void R_DrawRedToGreenColumn(colcontext_t *dc);
+void R_DrawTranslucentRedToGreen33Column(colcontext_t *dc);
+void R_DrawPlayerSpriteColumn(colcontext_t *dc);
+void R_DrawSuperShotgunColumn(colcontext_t *dc);
+void R_DrawShadowColumn(colcontext_t *dc);
+void R_DrawSpectreShadowColumn(colcontext_t *dc);
+void R_DrawSolidShadowColumn(colcontext_t *dc);
+void R_DrawBloodSplatColumn(colcontext_t *dc);
+void R_DrawSolidBloodSplatColumn(colcontext_t *dc);
+void R_DrawMegaSphereColumn(colcontext_t *dc);
+void R_DrawSolidMegaSphereColumn(colcontext_t *dc);
 
 // The Spectre/Invisibility effect.
-void R_DrawFuzzColumn(void);
-void R_DrawPausedFuzzColumn(void);
+void R_DrawFuzzColumn(colcontext_t *dc);
+void R_DrawPausedFuzzColumn(colcontext_t *dc);
 void R_DrawFuzzColumns(void);
 void R_DrawPausedFuzzColumns(void);
 
 // Draw with color translation tables,
 //  for player sprite rendering,
 //  Green/Red/Blue/Indigo shirts.
-void R_DrawTranslatedColumn(void);
+void R_DrawTranslatedColumn(colcontext_t *dc);
 
 void R_VideoErase(unsigned int ofs, int count);
 
-extern int              ds_y;
-extern int              ds_x1;
-extern int              ds_x2;
-
-extern lighttable_t     *ds_colormap;
-
-extern fixed_t          ds_xfrac;
-extern fixed_t          ds_yfrac;
-extern fixed_t          ds_xstep;
-extern fixed_t          ds_ystep;
-
-// start of a 64*64 tile image
-extern byte             *ds_source;
-
 extern byte             *translationtables;
-extern byte             *dc_translation;
 
 // Span blitting for rows, floor/ceiling.
 // No Spectre effect needed.
-void R_DrawSpan(void);
+void R_DrawSpan(spancontext_t *ds);
+void R_DrawSpanSSE2(spancontext_t *ds);
+void R_DrawSpanAVX2(spancontext_t *ds);
 
 void R_InitBuffer(int width, int height);
 
+// Chooses between drawing the view straight to the screen or into a
+//  column-major buffer that R_TransposeView then copies to the screen.
+void R_SetViewBuffer(boolean transposed);
+void R_FillViewBuffer(int color);
+void R_TransposeView(void);
+
+// Stretches a view rendered below the size of its window to fill it.
+void R_UpscaleView(void);
+
 // Initialize color translation tables,
 //  for player rendering etc.
 void R_InitTranslationTables(void);
@@ -153,4 +179,7 @@ void R_FillBackScreen(void);
 // If the view size is not full screen, draws a border around it.
 void R_DrawViewBorder(void);
 
+// Times the column and span drawers.
+void R_BenchmarkDrawers(int frames);
+
 #endif
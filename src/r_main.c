@@ -43,9 +43,13 @@
 #include "c_console.h"
 #include "d_net.h"
 #include "doomstat.h"
+#include "i_system.h"
+#include "i_thread.h"
 #include "i_timer.h"
+#include "i_video.h"
 #include "m_config.h"
 #include "m_menu.h"
+#include "m_profile.h"
 #include "p_local.h"
 #include "r_sky.h"
 #include "v_video.h"
@@ -57,7 +61,7 @@
 int                     validcount = 1;
 
 lighttable_t            *fixedcolormap;
-extern lighttable_t     **walllights;
+extern THREADLOCAL lighttable_t **walllights;
 
 int                     centerx;
 int                     centery;
@@ -118,38 +122,80 @@ boolean                 translucency = TRANSLUCENCY_DEFAULT;
 
 boolean                 homindicator = HOMINDICATOR_DEFAULT;
 
+// Draw the view into a column-major buffer and transpose it to the screen.
+boolean                 columnmajor = COLUMNMAJOR_DEFAULT;
+
+// Lower the resolution of the view when frames take longer than 1/targetfps
+//  of a second, and raise it again when there is time to spare.
+int                     targetfps = TARGETFPS_DEFAULT;
+int                     viewscale = VIEWSCALE_DEFAULT;
+
 int                     r_frame_count;
 
+// Render the view in vertical strips, one per thread. Every thread
+// traverses the whole BSP, so walls, flats and sprites are drawn exactly
+// as they would be by a single thread, but only within its own strip.
+typedef struct
+{
+    SDL_Thread          *thread;
+    SDL_sem             *start;
+    SDL_sem             *done;
+    int                 x1;
+    int                 x2;
+    renderstats_t       stats;
+} renderthread_t;
+
+int                     renderthreads = RENDERTHREADS_DEFAULT;
+
+static renderthread_t   rthreads[RENDERTHREADS_MAX - 1];
+static int              numrthreads;
+static int              numstrips = 1;
+
+THREADLOCAL int         stripx1;
+THREADLOCAL int         stripx2;
+
+renderstats_t           renderstats;
+THREADLOCAL renderstats_t   stripstats;
+
+// whether to time the stages of each strip, for the profiler
+static boolean          timestrips;
+
+static lighttable_t     *scalelightfixed[MAXLIGHTSCALE];
+
 extern int              viewheight2;
 extern int              gametic;
+extern int              graphicdetail;
+extern int              pixelwidth;
+extern int              pixelheight;
 extern boolean          canmodify;
-
-void (*colfunc)(void);
-void (*wallcolfunc)(void);
-void (*fbwallcolfunc)(void);
-void (*basecolfunc)(void);
-void (*fuzzcolfunc)(void);
-void (*tlcolfunc)(void);
-void (*tl50colfunc)(void);
-void (*tl33colfunc)(void);
-void (*tlgreencolfunc)(void);
-void (*tlredcolfunc)(void);
-void (*tlredwhitecolfunc)(void);
-void (*tlredwhite50colfunc)(void);
-void (*tlbluecolfunc)(void);
-void (*tlgreen50colfunc)(void);
-void (*tlred50colfunc)(void);
-void (*tlblue50colfunc)(void);
-void (*redtobluecolfunc)(void);
-void (*transcolfunc)(void);
-void (*spanfunc)(void);
-void (*skycolfunc)(void);
-void (*redtogreencolfunc)(void);
-void (*tlredtoblue33colfunc)(void);
-void (*tlredtogreen33colfunc)(void);
-void (*psprcolfunc)(void);
-void (*bloodsplatcolfunc)(void);
-void (*megaspherecolfunc)(void);
+extern boolean          inhelpscreens;
+
+THREADLOCAL void (*colfunc)(colcontext_t *);
+void (*wallcolfunc)(colcontext_t *);
+void (*fbwallcolfunc)(colcontext_t *);
+void (*basecolfunc)(colcontext_t *);
+void (*fuzzcolfunc)(colcontext_t *);
+void (*tlcolfunc)(colcontext_t *);
+void (*tl50colfunc)(colcontext_t *);
+void (*tl33colfunc)(colcontext_t *);
+void (*tlgreencolfunc)(colcontext_t *);
+void (*tlredcolfunc)(colcontext_t *);
+void (*tlredwhitecolfunc)(colcontext_t *);
+void (*tlredwhite50colfunc)(colcontext_t *);
+void (*tlbluecolfunc)(colcontext_t *);
+void (*tlgreen50colfunc)(colcontext_t *);
+void (*tlred50colfunc)(colcontext_t *);
+void (*tlblue50colfunc)(colcontext_t *);
+void (*redtobluecolfunc)(colcontext_t *);
+void (*transcolfunc)(colcontext_t *);
+void (*spanfunc)(spancontext_t *);
+void (*skycolfunc)(colcontext_t *);
+void (*redtogreencolfunc)(colcontext_t *);
+void (*tlredtoblue33colfunc)(colcontext_t *);
+void (*tlredtogreen33colfunc)(colcontext_t *);
+void (*psprcolfunc)(colcontext_t *);
+void (*bloodsplatcolfunc)(colcontext_t *);
+void (*megaspherecolfunc)(colcontext_t *);
 
 //
 // R_PointOnSide
@@ -349,6 +395,10 @@ static void R_InitPointToAngle(void)
 // e6y: caching
 angle_t R_GetVertexViewAngle(vertex_t *v)
 {
+    // vertices are shared by all render threads, so don't cache in them
+    if (numstrips > 1)
+        return R_PointToAngle(v->x, v->y);
+
     if (v->angletime != r_frame_count)
     {
         v->angletime = r_frame_count;
@@ -472,23 +522,43 @@ void R_ExecuteSetViewSize(void)
 {
     int i;
     int j;
+    int aspectx = 1;
+    int aspecty = 1;
 
     setsizeneeded = false;
 
     if (setblocks == 11)
     {
         scaledviewwidth = SCREENWIDTH;
-        viewheight = SCREENHEIGHT;
+        scaledviewheight = SCREENHEIGHT;
         viewheight2 = SCREENHEIGHT;
     }
     else
     {
         scaledviewwidth = setblocks * SCREENWIDTH / 10;
-        viewheight = (setblocks * (SCREENHEIGHT - SBARHEIGHT) / 10) & ~7;
+        scaledviewheight = (setblocks * (SCREENHEIGHT - SBARHEIGHT) / 10) & ~7;
         viewheight2 = SCREENHEIGHT - SBARHEIGHT;
     }
 
-    viewwidth = scaledviewwidth;
+    // the view is rendered at viewscale percent of the size of its window,
+    //  or at one pixel per pixelwidth x pixelheight block of it when the
+    //  graphic detail is low, and R_UpscaleView then stretches it to fill
+    //  the window
+    if (graphicdetail == LOW)
+    {
+        viewwidth = (scaledviewwidth + pixelwidth - 1) / pixelwidth;
+        viewheight = (scaledviewheight + pixelheight - 1) / pixelheight;
+
+        // pixels that aren't square are pixelwidth / pixelheight times as many
+        //  to the unit vertically as they are horizontally
+        aspectx = pixelwidth;
+        aspecty = pixelheight;
+    }
+    else
+    {
+        viewwidth = scaledviewwidth * viewscale / 100;
+        viewheight = scaledviewheight * viewscale / 100;
+    }
     viewheightfrac = viewheight << FRACBITS;
 
     centery = viewheight / 2;
@@ -496,16 +566,19 @@ void R_ExecuteSetViewSize(void)
     centerxfrac = centerx << FRACBITS;
     centeryfrac = centery << FRACBITS;
     projection = centerxfrac;
-    projectiony = ((SCREENHEIGHT * centerx * ORIGINALWIDTH) / ORIGINALHEIGHT) / SCREENWIDTH * FRACUNIT;
+    projectiony = ((SCREENHEIGHT * centerx * ORIGINALWIDTH * aspectx) / (ORIGINALHEIGHT * aspecty))
+        / SCREENWIDTH * FRACUNIT;
 
-    R_InitBuffer(scaledviewwidth, viewheight);
+    R_InitBuffer(scaledviewwidth, scaledviewheight);
 
     R_InitTextureMapping();
 
     // psprite scales
     pspritexscale = (centerx << FRACBITS) / (ORIGINALWIDTH / 2);
-    pspriteyscale = (((SCREENHEIGHT * viewwidth) / SCREENWIDTH) << FRACBITS) / ORIGINALHEIGHT;
+    pspriteyscale = (((SCREENHEIGHT * viewwidth * aspectx) / (SCREENWIDTH * aspecty)) << FRACBITS)
+        / ORIGINALHEIGHT;
     pspriteiscale = FixedDiv(FRACUNIT, pspritexscale);
+    skyiscale = FixedDiv(FRACUNIT, pspriteyscale);
 
     // thing clipping
     for (i = 0; i < viewwidth; i++)
@@ -589,7 +662,14 @@ void R_InitColumnFunctions(void)
         megaspherecolfunc = R_DrawSolidMegaSphereColumn;
     }
 
-    spanfunc = R_DrawSpan;
+#if defined(X86_CPU)
+    if (I_GetCPUFeatures() & CPU_AVX2)
+        spanfunc = R_DrawSpanAVX2;
+    else if (I_GetCPUFeatures() & CPU_SSE2)
+        spanfunc = R_DrawSpanSSE2;
+    else
+#endif
+        spanfunc = R_DrawSpan;
     redtobluecolfunc = R_DrawRedToBlueColumn;
     redtogreencolfunc = R_DrawRedToGreenColumn;
     wallcolfunc = R_DrawWallColumn;
@@ -708,6 +788,8 @@ void R_SetupFrame(player_t *player)
     viewsin = finesine[viewangle >> ANGLETOFINESHIFT];
     viewcos = finecosine[viewangle >> ANGLETOFINESHIFT];
 
+    R_InterpolateSectors();
+
     // killough 3/20/98, 4/4/98: select colormap based on player status
     if (player->mo->subsector->sector->heightsec != -1)
     {
@@ -727,15 +809,11 @@ void R_SetupFrame(player_t *player)
 
     if (player->fixedcolormap)
     {
-        // killough 3/20/98: localize scalelightfixed (readability/optimization)
-        static lighttable_t     *scalelightfixed[MAXLIGHTSCALE];
-        int                     i;
+        int     i;
 
         fixedcolormap = fullcolormap   // killough 3/20/98: use fullcolormap
             + player->fixedcolormap * 256 * sizeof(lighttable_t);
 
-        walllights = scalelightfixed;
-
         for (i = 0; i<MAXLIGHTSCALE; i++)
             scalelightfixed[i] = fixedcolormap;
     }
@@ -746,13 +824,19 @@ void R_SetupFrame(player_t *player)
 }
 
 //
-// R_RenderView
+// R_RenderStrip
+// Render the columns from x1 to x2 (inclusive) of the view, and return the
+//  counters for them in stats.
 //
-void R_RenderPlayerView(player_t *player)
+static void R_RenderStrip(int x1, int x2, renderstats_t *stats)
 {
-    r_frame_count++;
+    stripx1 = x1;
+    stripx2 = x2;
 
-    R_SetupFrame(player);
+    memset(&stripstats, 0, sizeof(stripstats));
+
+    if (fixedcolormap)
+        walllights = scalelightfixed;
 
     // Clear buffers.
     R_ClearClipSegs();
@@ -760,23 +844,207 @@ void R_RenderPlayerView(player_t *player)
     R_ClearPlanes();
     R_ClearSprites();
 
+    // The head node is the last node output.
+    if (timestrips)
+    {
+        uint64_t        start = I_GetTimeUS();
+
+        R_RenderBSPNode(numnodes - 1);
+        stripstats.bsptime = (int)(I_GetTimeUS() - start);
+
+        start = I_GetTimeUS();
+        R_DrawPlanes();
+        stripstats.planetime = (int)(I_GetTimeUS() - start);
+
+        start = I_GetTimeUS();
+        R_DrawMasked();
+        stripstats.maskedtime = (int)(I_GetTimeUS() - start);
+    }
+    else
+    {
+        R_RenderBSPNode(numnodes - 1);
+        R_DrawPlanes();
+        R_DrawMasked();
+    }
+
+    *stats = stripstats;
+}
+
+static int R_RenderThread(void *data)
+{
+    renderthread_t      *rthread = (renderthread_t *)data;
+
+    while (true)
+    {
+        I_SemWait(rthread->start);
+        R_RenderStrip(rthread->x1, rthread->x2, &rthread->stats);
+        I_SemPost(rthread->done);
+    }
+
+    return 0;
+}
+
+//
+// R_RenderStrips
+// Split the view between the main thread and renderthreads - 1 others.
+//
+static void R_RenderStrips(void)
+{
+    int i;
+
+    numstrips = MIN(renderthreads, viewwidth);
+
+    // start any more threads that are needed
+    while (numrthreads < numstrips - 1)
+    {
+        renderthread_t  *rthread = &rthreads[numrthreads++];
+
+        rthread->start = I_CreateSemaphore(0);
+        rthread->done = I_CreateSemaphore(0);
+        rthread->thread = I_CreateThread(R_RenderThread, "render", rthread);
+    }
+
+    for (i = 1; i < numstrips; i++)
+    {
+        renderthread_t  *rthread = &rthreads[i - 1];
+
+        rthread->x1 = viewwidth * i / numstrips;
+        rthread->x2 = viewwidth * (i + 1) / numstrips - 1;
+        I_SemPost(rthread->start);
+    }
+
+    R_RenderStrip(0, viewwidth / numstrips - 1, &renderstats);
+
+    for (i = 1; i < numstrips; i++)
+    {
+        renderstats_t   *stats = &rthreads[i - 1].stats;
+
+        I_SemWait(rthreads[i - 1].done);
+
+        renderstats.visplanes += stats->visplanes;
+        renderstats.visplanebuckets = MAX(renderstats.visplanebuckets, stats->visplanebuckets);
+        renderstats.visplanebytes += stats->visplanebytes;
+        renderstats.mapplanehits += stats->mapplanehits;
+        renderstats.mapplanemisses += stats->mapplanemisses;
+
+        // the view is done when the slowest strip is
+        renderstats.bsptime = MAX(renderstats.bsptime, stats->bsptime);
+        renderstats.planetime = MAX(renderstats.planetime, stats->planetime);
+        renderstats.maskedtime = MAX(renderstats.maskedtime, stats->maskedtime);
+    }
+
+    R_MarkMappedLines();
+
+    numstrips = 1;
+}
+
+//
+// R_UpdateViewScale
+// Adjusts viewscale from the average time recent frames took to render and
+//  finish, and resizes the view if it changed. Waiting for the next tic when
+//  vid_capfps is on, and for the display when presenting, aren't counted, as
+//  a smaller view wouldn't shorten them. Once changed, it is left alone for a
+//  few frames so the average can catch up.
+//
+static uint64_t         renderstart;
+
+static void R_UpdateViewScale(void)
+{
+    static uint64_t     frametime;
+    static int          settle;
+    uint64_t            now = I_GetTimeUS();
+    uint64_t            elapsed = (renderstart && framefinished > renderstart ?
+                            framefinished - renderstart : 250000);
+    int                 scale = viewscale;
+
+    renderstart = now;
+
+    if (!targetfps || graphicdetail == LOW)
+        scale = VIEWSCALE_MAX;
+    else if (elapsed < 250000)  // ignore stalls, such as when loading a map, and the first frame
+    {
+        const uint64_t  budget = 1000000 / targetfps;
+
+        frametime = (frametime * 7 + elapsed) / 8;
+
+        if (settle)
+            --settle;
+        else if (frametime > budget + budget / 20)
+            scale = MAX(VIEWSCALE_MIN, viewscale - 5);
+        else if (frametime < budget - budget / 5)
+            scale = MIN(VIEWSCALE_MAX, viewscale + 5);
+    }
+
+    if (scale != viewscale)
+    {
+        viewscale = scale;
+        settle = 8;
+        R_ExecuteSetViewSize();
+    }
+}
+
+//
+// R_RenderView
+//
+void R_RenderPlayerView(player_t *player)
+{
+    r_frame_count++;
+
+    if (!automapactive)
+        R_UpdateViewScale();
+
+    M_ProfileBegin(PROFILE_SETUPFRAME);
+    R_SetupFrame(player);
+    M_ProfileEnd(PROFILE_SETUPFRAME);
+
     if (automapactive)
     {
+        // the next frame of the view has no frame before it to time
+        renderstart = 0;
+
+        stripx1 = 0;
+        stripx2 = viewwidth - 1;
+
+        // Clear buffers.
+        R_ClearClipSegs();
+        R_ClearDrawSegs();
+        R_ClearPlanes();
+        R_ClearSprites();
+
         // The head node is the last node output.
+        M_ProfileBegin(PROFILE_BSP);
         R_RenderBSPNode(numnodes - 1);
+        M_ProfileEnd(PROFILE_BSP);
     }
     else
     {
+        R_SetViewBuffer(columnmajor);
+
         if (player->cheats & CF_NOCLIP)
-            V_FillRect(0, viewwindowx, viewwindowy, viewwidth, viewheight, 0);
+            R_FillViewBuffer(0);
         else if (homindicator)
-            V_FillRect(0, viewwindowx, viewwindowy, viewwidth, viewheight,
-                ((gametic % 20) < 9 && !consoleactive && !menuactive && !paused ? 176 : 0));
+            R_FillViewBuffer((gametic % 20) < 9 && !consoleactive && !menuactive && !paused ? 176 : 0);
 
-        // The head node is the last node output.
-        R_RenderBSPNode(numnodes - 1);
+        R_UpdateDistortedFlats();
 
-        R_DrawPlanes();
-        R_DrawMasked();
+        timestrips = M_Profiling();
+        R_RenderStrips();
+
+        M_ProfileAdd(PROFILE_BSP, renderstats.bsptime);
+        M_ProfileAdd(PROFILE_PLANES, renderstats.planetime);
+        M_ProfileAdd(PROFILE_MASKED, renderstats.maskedtime);
+
+        if (columnmajor)
+        {
+            R_TransposeView();
+            R_SetViewBuffer(false);
+        }
+
+        // draw the psprites on top of everything
+        if (!inhelpscreens)
+            R_DrawPlayerSprites();
+
+        if (viewwidth != scaledviewwidth || viewheight != scaledviewheight)
+            R_UpscaleView();
     }
 }
@@ -41,6 +41,7 @@
 
 #include "d_player.h"
 #include "r_data.h"
+#include "r_draw.h"
 
 //
 // POV related.
@@ -61,6 +62,28 @@ extern fixed_t          projectiony;
 
 extern int              validcount;
 
+// The columns of the view drawn by the current render thread.
+extern THREADLOCAL int  stripx1;
+extern THREADLOCAL int  stripx2;
+
+// Counters for the last frame rendered, shown by the renderstats CMD.
+typedef struct
+{
+    int                 visplanes;
+    int                 visplanebuckets;
+    int                 visplanebytes;  // bytes of visplane top[] initialized
+    int                 mapplanehits;   // rows R_MapPlane found in its cache
+    int                 mapplanemisses;
+    int                 bsptime;        // microseconds in R_RenderBSPNode
+    int                 planetime;      // microseconds in R_DrawPlanes
+    int                 maskedtime;     // microseconds in R_DrawMasked
+} renderstats_t;
+
+extern renderstats_t    renderstats;
+
+// Counters for the strip being rendered by the current thread.
+extern THREADLOCAL renderstats_t    stripstats;
+
 //
 // Lighting LUT.
 // Used for z-depth cuing per column/row,
@@ -98,32 +121,32 @@ extern fixed_t          fractionaltic;
 // Function pointers to switch refresh/drawing functions.
 // Used to select shadow mode etc.
 //
-extern void (*colfunc)(void);
-extern void (*wallcolfunc)(void);
-extern void (*fbwallcolfunc)(void);
-extern void (*transcolfunc)(void);
-extern void (*basecolfunc)(void);
-extern void (*fuzzcolfunc)(void);
-extern void (*tlcolfunc)(void);
-extern void (*tl50colfunc)(void);
-extern void (*tl33colfunc)(void);
-extern void (*tlgreencolfunc)(void);
-extern void (*tlredcolfunc)(void);
-extern void (*tlredwhitecolfunc)(void);
-extern void (*tlredwhite50colfunc)(void);
-extern void (*tlbluecolfunc)(void);
-extern void (*tlgreen50colfunc)(void);
-extern void (*tlred50colfunc)(void);
-extern void (*tlblue50colfunc)(void);
-extern void (*redtobluecolfunc)(void);
-extern void (*tlredtoblue33colfunc)(void);
-extern void (*skycolfunc)(void);
-extern void (*redtogreencolfunc)(void);
-extern void (*tlredtogreen33colfunc)(void);
-extern void (*psprcolfunc)(void);
-extern void (*spanfunc)(void);
-extern void (*bloodsplatcolfunc)(void);
-extern void (*megaspherecolfunc)(void);
+extern THREADLOCAL void (*colfunc)(colcontext_t *);
+extern void (*wallcolfunc)(colcontext_t *);
+extern void (*fbwallcolfunc)(colcontext_t *);
+extern void (*transcolfunc)(colcontext_t *);
+extern void (*basecolfunc)(colcontext_t *);
+extern void (*fuzzcolfunc)(colcontext_t *);
+extern void (*tlcolfunc)(colcontext_t *);
+extern void (*tl50colfunc)(colcontext_t *);
+extern void (*tl33colfunc)(colcontext_t *);
+extern void (*tlgreencolfunc)(colcontext_t *);
+extern void (*tlredcolfunc)(colcontext_t *);
+extern void (*tlredwhitecolfunc)(colcontext_t *);
+extern void (*tlredwhite50colfunc)(colcontext_t *);
+extern void (*tlbluecolfunc)(colcontext_t *);
+extern void (*tlgreen50colfunc)(colcontext_t *);
+extern void (*tlred50colfunc)(colcontext_t *);
+extern void (*tlblue50colfunc)(colcontext_t *);
+extern void (*redtobluecolfunc)(colcontext_t *);
+extern void (*tlredtoblue33colfunc)(colcontext_t *);
+extern void (*skycolfunc)(colcontext_t *);
+extern void (*redtogreencolfunc)(colcontext_t *);
+extern void (*tlredtogreen33colfunc)(colcontext_t *);
+extern void (*psprcolfunc)(colcontext_t *);
+extern void (*spanfunc)(spancontext_t *);
+extern void (*bloodsplatcolfunc)(colcontext_t *);
+extern void (*megaspherecolfunc)(colcontext_t *);
 
 //
 // Utility functions.
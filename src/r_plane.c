@@ -46,84 +46,109 @@
 #include "w_wad.h"
 #include "z_zone.h"
 
-#define MAXVISPLANES    128                             // must be a power of 2
-
-static visplane_t       *visplanes[MAXVISPLANES];       // killough
-static visplane_t       *freetail;                      // killough
-static visplane_t       **freehead = &freetail;         // killough
-visplane_t              *floorplane;
-visplane_t              *ceilingplane;
+// The visplane hash table starts at MINVISPLANES buckets, and is resized
+//  between frames to keep about two visplanes per bucket.
+#define MINVISPLANES    128                             // must be a power of 2
+#define MAXVISPLANES    4096                            // must be a power of 2
+
+static THREADLOCAL visplane_t   **visplanes;                    // killough
+static THREADLOCAL unsigned int numvisplanebuckets;
+static THREADLOCAL int          numvisplanes;                   // created this frame
+static THREADLOCAL visplane_t   *freetail;                      // killough
+static THREADLOCAL visplane_t   **freehead;                     // killough
+THREADLOCAL visplane_t          *floorplane;
+THREADLOCAL visplane_t          *ceilingplane;
 
 // killough -- hash function for visplanes
 // Empirically verified to be fairly uniform:
 #define visplane_hash(picnum, lightlevel, height) \
     (((unsigned int)(picnum) * 3 + (unsigned int)(lightlevel) + \
-    (unsigned int)(height) * 7) & (MAXVISPLANES - 1))
+    (unsigned int)(height) * 7) & (numvisplanebuckets - 1))
 
-size_t                 maxopenings;
-int                    *openings;                       // dropoff overflow
-int                    *lastopening;                    // dropoff overflow
+THREADLOCAL size_t              maxopenings;
+THREADLOCAL int                 *openings;                      // dropoff overflow
+THREADLOCAL int                 *lastopening;                   // dropoff overflow
 
 // Clip values are the solid pixel bounding the range.
 //  floorclip starts out SCREENHEIGHT
 //  ceilingclip starts out -1
-int                     floorclip[SCREENWIDTH];         // dropoff overflow
-int                     ceilingclip[SCREENWIDTH];       // dropoff overflow
+THREADLOCAL int                 floorclip[SCREENWIDTH];         // dropoff overflow
+THREADLOCAL int                 ceilingclip[SCREENWIDTH];       // dropoff overflow
 
 // spanstart holds the start of a plane span
 // initialized to 0 at start
-static int              spanstart[SCREENHEIGHT];
+static THREADLOCAL int          spanstart[SCREENHEIGHT];
 
 // texture mapping
-static lighttable_t     **planezlight;
-static fixed_t          planeheight;
+static THREADLOCAL lighttable_t **planezlight;
+static THREADLOCAL fixed_t      planeheight;
+
+// killough 2/8/98: for R_MapPlane. The distance and steps for each row,
+//  kept while consecutive visplanes on it have the same height, and
+//  invalidated every frame since they depend on the view.
+static THREADLOCAL fixed_t      cachedheight[SCREENHEIGHT];
+static THREADLOCAL fixed_t      cacheddistance[SCREENHEIGHT];
+static THREADLOCAL fixed_t      cachedxstep[SCREENHEIGHT];
+static THREADLOCAL fixed_t      cachedystep[SCREENHEIGHT];
 
-static fixed_t          xoffs, yoffs;                   // killough 2/28/98: flat offsets
+static THREADLOCAL fixed_t      xoffs, yoffs;                   // killough 2/28/98: flat offsets
 
-fixed_t                 yslope[SCREENHEIGHT];
-fixed_t                 distscale[SCREENWIDTH];
+fixed_t                         yslope[SCREENHEIGHT];
+fixed_t                         distscale[SCREENWIDTH];
 
-boolean                 swirlingliquid = SWIRLINGLIQUID_DEFAULT;
+boolean                         swirlingliquid = SWIRLINGLIQUID_DEFAULT;
 
 //
 // R_MapPlane
 //
 // Uses global vars:
 //  planeheight
-//  ds_source
 //  viewx
 //  viewy
 //
 // BASIC PRIMITIVE
 //
-static void R_MapPlane(int y, int x1, int x2)
+static void R_MapPlane(spancontext_t *ds, int y, int x1, int x2)
 {
     fixed_t     distance;
-    int         dx, dy;
+    int         dx;
 
     if (y == centery)
         return;
 
-    distance = FixedMul(planeheight, yslope[y]);
+    if (planeheight == cachedheight[y])
+    {
+        distance = cacheddistance[y];
+        ds->xstep = cachedxstep[y];
+        ds->ystep = cachedystep[y];
+        stripstats.mapplanehits++;
+    }
+    else
+    {
+        int     dy = ABS(centery - y);
+
+        cachedheight[y] = planeheight;
+        distance = cacheddistance[y] = FixedMul(planeheight, yslope[y]);
+        ds->xstep = cachedxstep[y] = FixedMul(viewsin, planeheight) / dy;
+        ds->ystep = cachedystep[y] = FixedMul(viewcos, planeheight) / dy;
+        stripstats.mapplanemisses++;
+    }
 
     dx = x1 - centerx;
-    dy = ABS(centery - y);
-    ds_xstep = FixedMul(viewsin, planeheight) / dy;
-    ds_ystep = FixedMul(viewcos, planeheight) / dy;
 
-    ds_xfrac = viewx + xoffs + FixedMul(viewcos, distance) + dx * ds_xstep;
-    ds_yfrac = -viewy + yoffs - FixedMul(viewsin, distance) + dx * ds_ystep;
+    ds->xfrac = viewx + xoffs + FixedMul(viewcos, distance) + dx * ds->xstep;
+    ds->yfrac = -viewy + yoffs - FixedMul(viewsin, distance) + dx * ds->ystep;
 
     if (fixedcolormap)
-        ds_colormap = fixedcolormap;
+        ds->colormap = fixedcolormap;
     else
-        ds_colormap = planezlight[BETWEEN(0, distance >> LIGHTZSHIFT, MAXLIGHTZ - 1)];
+        ds->colormap = planezlight[BETWEEN(0, distance >> LIGHTZSHIFT, MAXLIGHTZ - 1)];
 
-    ds_y = y;
-    ds_x1 = x1;
-    ds_x2 = x2;
+    ds->y = y;
+    ds->x1 = x1;
+    ds->x2 = x2;
 
-    spanfunc();
+    spanfunc(ds);
 }
 
 //
@@ -141,13 +166,54 @@ void R_ClearPlanes(void)
         ceilingclip[i] = -1;
     }
 
-    for (i = 0; i < MAXVISPLANES; i++)  // new code -- killough
+    if (!freehead)
+        freehead = &freetail;
+
+    for (i = 0; i < (int)numvisplanebuckets; i++)       // new code -- killough
         for (*freehead = visplanes[i], visplanes[i] = NULL; *freehead;)
             freehead = &(*freehead)->next;
 
+    // resize the hash table if last frame's visplanes didn't suit it
+    if (!visplanes || (numvisplanes > (int)numvisplanebuckets * 2 && numvisplanebuckets < MAXVISPLANES)
+        || (numvisplanes < (int)numvisplanebuckets / 8 && numvisplanebuckets > MINVISPLANES))
+    {
+        unsigned int    size = MINVISPLANES;
+
+        while ((int)size * 2 < numvisplanes && size < MAXVISPLANES)
+            size <<= 1;
+
+        free(visplanes);
+        visplanes = calloc(size, sizeof(*visplanes));
+        numvisplanebuckets = size;
+    }
+
+    numvisplanes = 0;
+    stripstats.visplanebuckets = numvisplanebuckets;
+
+    // the view has moved, so forget the distances R_MapPlane worked out
+    for (i = 0; i < viewheight; i++)
+        cachedheight[i] = INT_MIN;
+
     lastopening = openings;
 }
 
+//
+// R_ClearPlaneColumns
+// Marks the columns from x1 to x2 of a visplane as unused. Only columns
+//  that fall between a visplane's minx and maxx are ever read, so this is
+//  done as that range grows instead of for the whole width of the screen
+//  whenever a visplane is created.
+//
+static void R_ClearPlaneColumns(visplane_t *pl, int x1, int x2)
+{
+    int x;
+
+    for (x = x1; x <= x2; x++)
+        pl->top[x] = SHRT_MAX;
+
+    stripstats.visplanebytes += (x2 - x1 + 1) * sizeof(pl->top[0]);
+}
+
 // New function, by Lee Killough
 static visplane_t *new_visplane(unsigned hash)
 {
@@ -159,6 +225,8 @@ static visplane_t *new_visplane(unsigned hash)
         freehead = &freetail;
     check->next = visplanes[hash];
     visplanes[hash] = check;
+    numvisplanes++;
+    stripstats.visplanes++;
     return check;
 }
 
@@ -191,8 +259,6 @@ visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel, fixed_t xoff
     check->xoffs = xoffs;               // killough 2/28/98: Save offsets
     check->yoffs = yoffs;
 
-    memset(check->top, SHRT_MAX, sizeof(check->top));
-
     return check;
 }
 
@@ -235,6 +301,17 @@ visplane_t *R_CheckPlane(visplane_t *pl, int start, int stop)
     // visplane (e.g. both skies)
     if (!(pl == floorplane && markceiling && floorplane == ceilingplane) && x > intrh)
     {
+        // initialize the columns the visplane grows into
+        if (pl->minx > pl->maxx)
+            R_ClearPlaneColumns(pl, unionl, unionh);
+        else
+        {
+            if (unionl < pl->minx)
+                R_ClearPlaneColumns(pl, unionl, pl->minx - 1);
+            if (unionh > pl->maxx)
+                R_ClearPlaneColumns(pl, pl->maxx + 1, unionh);
+        }
+
         pl->minx = unionl;
         pl->maxx = unionh;
     }
@@ -252,7 +329,7 @@ visplane_t *R_CheckPlane(visplane_t *pl, int start, int stop)
         pl = new_pl;
         pl->minx = start;
         pl->maxx = stop;
-        memset(pl->top, SHRT_MAX, sizeof(pl->top));
+        R_ClearPlaneColumns(pl, start, stop);
     }
 
     return pl;
@@ -261,12 +338,12 @@ visplane_t *R_CheckPlane(visplane_t *pl, int start, int stop)
 //
 // R_MakeSpans
 //
-static void R_MakeSpans(int x, unsigned int t1, unsigned int b1, unsigned int t2, unsigned int b2)
+static void R_MakeSpans(spancontext_t *ds, int x, unsigned int t1, unsigned int b1, unsigned int t2, unsigned int b2)
 {
     for (; t1 < t2 && t1 <= b1; t1++)
-        R_MapPlane(t1, spanstart[t1], x - 1);
+        R_MapPlane(ds, t1, spanstart[t1], x - 1);
     for (; b1 > b2 && b1 >= t1; b1--)
-        R_MapPlane(b1, spanstart[b1], x - 1);
+        R_MapPlane(ds, b1, spanstart[b1], x - 1);
     while (t2 < t1 && t2 <= b2)
         spanstart[t2++] = x;
     while (b2 > b1 && b2 >= t2)
@@ -285,61 +362,74 @@ static void R_MakeSpans(int x, unsigned int t1, unsigned int b1, unsigned int t2
 // 1 cycle per 32 units (2 in 64)
 #define SWIRLFACTOR2    (8192 / 32)
 
-char    *normalflat;
-char    distortedflat[4096];
+static int      offset[4096];
+static int      swirltic = -1;
+
+// the first 4 bytes are padding for R_DrawSpanAVX2, which reads the
+//  3 bytes before each texel
+static THREADLOCAL char distortedflat[4 + 4096];
 
 //
-// R_DistortedFlat
+// R_UpdateDistortedFlats
 //
-// Generates a distorted flat from a normal one using a two-dimensional
-// sine wave pattern.
+// Builds the offsets used by R_DistortedFlat for this tic. Called once per
+// frame before rendering, so render threads only read them.
 //
-char *R_DistortedFlat(int flatnum)
+void R_UpdateDistortedFlats(void)
 {
-    static int  swirltic = -1;
-    static int  offset[4096];
-    int         i;
-    int         leveltic = I_GetTime();
+    int         x, y;
+    int         leveltic;
 
     // built this tic?
-    if (gametic != swirltic)
-    {
-        int     x, y;
+    if (gametic == swirltic)
+        return;
 
-        for (x = 0; x < 64; x++)
-            for (y = 0; y < 64; y++)
-            {
-                int     x1, y1;
-                int     sinvalue, sinvalue2;
+    leveltic = I_GetTime();
 
-                sinvalue = (y * SWIRLFACTOR + leveltic * SPEED * 5 + 900) & 8191;
-                sinvalue2 = (x * SWIRLFACTOR2 + leveltic * SPEED * 4 + 300) & 8191;
-                x1 = x + 128 + ((finesine[sinvalue] * AMP) >> FRACBITS)
-                    + ((finesine[sinvalue2] * AMP2) >> FRACBITS);
+    for (x = 0; x < 64; x++)
+        for (y = 0; y < 64; y++)
+        {
+            int     x1, y1;
+            int     sinvalue, sinvalue2;
 
-                sinvalue = (x * SWIRLFACTOR + leveltic * SPEED * 3 + 700) & 8191;
-                sinvalue2 = (y * SWIRLFACTOR2 + leveltic * SPEED * 4 + 1200) & 8191;
-                y1 = y + 128 + ((finesine[sinvalue] * AMP) >> FRACBITS)
-                    + ((finesine[sinvalue2] * AMP2) >> FRACBITS);
+            sinvalue = (y * SWIRLFACTOR + leveltic * SPEED * 5 + 900) & 8191;
+            sinvalue2 = (x * SWIRLFACTOR2 + leveltic * SPEED * 4 + 300) & 8191;
+            x1 = x + 128 + ((finesine[sinvalue] * AMP) >> FRACBITS)
+                + ((finesine[sinvalue2] * AMP2) >> FRACBITS);
 
-                x1 &= 63;
-                y1 &= 63;
+            sinvalue = (x * SWIRLFACTOR + leveltic * SPEED * 3 + 700) & 8191;
+            sinvalue2 = (y * SWIRLFACTOR2 + leveltic * SPEED * 4 + 1200) & 8191;
+            y1 = y + 128 + ((finesine[sinvalue] * AMP) >> FRACBITS)
+                + ((finesine[sinvalue2] * AMP2) >> FRACBITS);
 
-                offset[(y << 6) + x] = (y1 << 6) + x1;
-            }
+            x1 &= 63;
+            y1 &= 63;
 
-        swirltic = gametic;
-    }
+            offset[(y << 6) + x] = (y1 << 6) + x1;
+        }
 
-    normalflat = W_CacheLumpNum(firstflat + flatnum, PU_STATIC);
+    swirltic = gametic;
+}
+
+//
+// R_DistortedFlat
+//
+// Generates a distorted flat from a normal one using a two-dimensional
+// sine wave pattern.
+//
+char *R_DistortedFlat(int flatnum)
+{
+    int         lumpnum = firstflat + flatnum;
+    char        *normalflat = W_CacheLumpNum(lumpnum, PU_STATIC);
+    int         i;
 
     for (i = 0; i < 4096; i++)
-        distortedflat[i] = normalflat[offset[i]];
+        distortedflat[4 + i] = normalflat[offset[i]];
 
     // free the original
-    Z_ChangeTag(normalflat, PU_CACHE);
+    W_ReleaseLumpNum(lumpnum);
 
-    return distortedflat;
+    return &distortedflat[4];
 }
 
 //
@@ -350,7 +440,7 @@ void R_DrawPlanes(void)
 {
     int i;
 
-    for (i = 0; i < MAXVISPLANES; i++)
+    for (i = 0; i < (int)numvisplanebuckets; i++)
     {
         visplane_t      *pl;
 
@@ -361,43 +451,45 @@ void R_DrawPlanes(void)
                 // sky flat
                 if (pl->picnum == skyflatnum)
                 {
-                    int x;
-                    
-                    dc_iscale = pspriteiscale;
+                    int             x;
+                    colcontext_t    dc;
+
+                    dc.iscale = skyiscale;
 
                     // Sky is always drawn full bright,
                     //  i.e. colormaps[0] is used.
                     // Because of this hack, sky is not affected
                     //  by INVUL inverse mapping.
-                    dc_colormap = (fixedcolormap ? fixedcolormap : fullcolormap);
-                    dc_texturemid = skytexturemid;
-                    dc_texheight = textureheight[skytexture] >> FRACBITS;
+                    dc.colormap = (fixedcolormap ? fixedcolormap : fullcolormap);
+                    dc.texturemid = skytexturemid;
+                    dc.texheight = textureheight[skytexture] >> FRACBITS;
                     for (x = pl->minx; x <= pl->maxx; x++)
                     {
-                        dc_yl = pl->top[x];
-                        dc_yh = pl->bottom[x];
+                        dc.yl = pl->top[x];
+                        dc.yh = pl->bottom[x];
 
-                        if (dc_yl != SHRT_MAX && dc_yl <= dc_yh)
+                        if (dc.yl != SHRT_MAX && dc.yl <= dc.yh)
                         {
-                            dc_x = x;
-                            dc_source = R_GetColumn(skytexture,
+                            dc.x = x;
+                            dc.source = R_GetColumn(skytexture,
                                 (viewangle + xtoviewangle[x]) >> ANGLETOSKYSHIFT);
-                            skycolfunc();
+                            skycolfunc(&dc);
                         }
                     }
                 }
                 else
                 {
                     // regular flat
-                    int         picnum = pl->picnum;
-                    boolean     liquid = isliquid[picnum];
-                    boolean     swirling = (liquid && swirlingliquid);
-                    int         lumpnum = firstflat + flattranslation[picnum];
-                    int         light = (pl->lightlevel >> LIGHTSEGSHIFT) + extralight * LIGHTBRIGHT;
-                    int         stop = pl->maxx + 1;
-                    int         x;
-
-                    ds_source = (swirling ? R_DistortedFlat(picnum) :
+                    int             picnum = pl->picnum;
+                    boolean         liquid = isliquid[picnum];
+                    boolean         swirling = (liquid && swirlingliquid);
+                    int             lumpnum = firstflat + flattranslation[picnum];
+                    int             light = (pl->lightlevel >> LIGHTSEGSHIFT) + extralight * LIGHTBRIGHT;
+                    int             stop = pl->maxx + 1;
+                    int             x;
+                    spancontext_t   ds;
+
+                    ds.source = (swirling ? R_DistortedFlat(picnum) :
                         W_CacheLumpNum(lumpnum, PU_STATIC));
 
                     xoffs = pl->xoffs;  // killough 2/28/98: Add offsets
@@ -412,7 +504,7 @@ void R_DrawPlanes(void)
                     pl->top[pl->minx - 1] = pl->top[stop] = SHRT_MAX;
 
                     for (x = pl->minx; x <= stop; x++)
-                        R_MakeSpans(x, pl->top[x - 1], pl->bottom[x - 1], pl->top[x], pl->bottom[x]);
+                        R_MakeSpans(&ds, x, pl->top[x - 1], pl->bottom[x - 1], pl->top[x], pl->bottom[x]);
 
                     if (!swirling)
                         W_ReleaseLumpNum(lumpnum);
@@ -42,22 +42,24 @@
 #include "r_data.h"
 
 // Visplane related.
-extern  int     *lastopening;
+extern THREADLOCAL int      *lastopening;
 
-extern int      floorclip[];
-extern int      ceilingclip[];
+extern THREADLOCAL int      floorclip[];
+extern THREADLOCAL int      ceilingclip[];
 
-extern fixed_t  yslope[];
-extern fixed_t  distscale[];
+extern fixed_t              yslope[];
+extern fixed_t              distscale[];
 
-extern boolean  markceiling;
+extern THREADLOCAL boolean  markceiling;
 
-extern boolean  brightmaps;
+extern boolean              brightmaps;
 
 void R_ClearPlanes(void);
 
 void R_DrawPlanes(void);
 
+void R_UpdateDistortedFlats(void);
+
 visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel, fixed_t xoffs, fixed_t yoffs);
 
 visplane_t *R_CheckPlane(visplane_t *pl, int start, int stop);
@@ -45,59 +45,64 @@
 
 // killough 1/6/98: replaced globals with statics where appropriate
 
-static boolean  segtextured;            // True if any of the segs textures might be visible.
+static THREADLOCAL boolean  segtextured;            // True if any of the segs textures might be visible.
 
-static boolean  markfloor;              // False if the back side is the same plane.
-boolean         markceiling;
+static THREADLOCAL boolean  markfloor;              // False if the back side is the same plane.
+THREADLOCAL boolean         markceiling;
 
-static boolean  maskedtexture;
-static int      toptexture;
-static int      midtexture;
-static int      bottomtexture;
+static THREADLOCAL boolean  maskedtexture;
+static THREADLOCAL int      toptexture;
+static THREADLOCAL int      midtexture;
+static THREADLOCAL int      bottomtexture;
 
-static fixed_t  toptexheight;
-static fixed_t  midtexheight;
-static fixed_t  bottomtexheight;
+static THREADLOCAL fixed_t  toptexheight;
+static THREADLOCAL fixed_t  midtexheight;
+static THREADLOCAL fixed_t  bottomtexheight;
 
-static byte     *toptexfullbright;
-static byte     *midtexfullbright;
-static byte     *bottomtexfullbright;
+static THREADLOCAL byte     *toptexfullbright;
+static THREADLOCAL byte     *midtexfullbright;
+static THREADLOCAL byte     *bottomtexfullbright;
 
-angle_t         rw_normalangle;
-fixed_t         rw_distance;
+THREADLOCAL angle_t         rw_normalangle;
+THREADLOCAL fixed_t         rw_distance;
 
 //
 // regular wall
 //
-static int      rw_x;
-static int      rw_stopx;
-static angle_t  rw_centerangle;
-static fixed_t  rw_offset;
-static fixed_t  rw_scale;
-static fixed_t  rw_scalestep;
-static fixed_t  rw_midtexturemid;
-static fixed_t  rw_toptexturemid;
-static fixed_t  rw_bottomtexturemid;
+static THREADLOCAL int      rw_x;
+static THREADLOCAL int      rw_stopx;
+static THREADLOCAL angle_t  rw_centerangle;
+static THREADLOCAL fixed_t  rw_offset;
+static THREADLOCAL fixed_t  rw_scale;
+static THREADLOCAL fixed_t  rw_scalestep;
+static THREADLOCAL fixed_t  rw_midtexturemid;
+static THREADLOCAL fixed_t  rw_toptexturemid;
+static THREADLOCAL fixed_t  rw_bottomtexturemid;
 
-static int      worldtop;
-static int      worldbottom;
-static int      worldhigh;
-static int      worldlow;
+static THREADLOCAL int      worldtop;
+static THREADLOCAL int      worldbottom;
+static THREADLOCAL int      worldhigh;
+static THREADLOCAL int      worldlow;
 
-static int64_t  pixhigh;
-static int64_t  pixlow;
-static fixed_t  pixhighstep;
-static fixed_t  pixlowstep;
+static THREADLOCAL int64_t  pixhigh;
+static THREADLOCAL int64_t  pixlow;
+static THREADLOCAL fixed_t  pixhighstep;
+static THREADLOCAL fixed_t  pixlowstep;
 
-static int64_t  topfrac;
-static fixed_t  topstep;
+static THREADLOCAL int64_t  topfrac;
+static THREADLOCAL fixed_t  topstep;
 
-static int64_t  bottomfrac;
-static fixed_t  bottomstep;
+static THREADLOCAL int64_t  bottomfrac;
+static THREADLOCAL fixed_t  bottomstep;
 
-lighttable_t    **walllights;
+THREADLOCAL lighttable_t    **walllights;
 
-static int      *maskedtexturecol;      // dropoff overflow
+static THREADLOCAL int      *maskedtexturecol;      // dropoff overflow
+
+// lines seen by the first strip, to be mapped once every strip is done
+static line_t   **mappedlines;
+static int      nummappedlines;
+static int      maxmappedlines;
 
 boolean         brightmaps = BRIGHTMAPS_DEFAULT;
 
@@ -142,10 +147,10 @@ extern boolean  translucency;
 //   increasing the precision of various renderer variables, and,
 //   possibly, creating a noticable performance penalty.
 //
-static int      max_rwscale = 64 * FRACUNIT;
-static int      heightbits = 12;
-static int      heightunit = (1 << 12);
-static int      invhgtbits = 4;
+static THREADLOCAL int      max_rwscale = 64 * FRACUNIT;
+static THREADLOCAL int      heightbits = 12;
+static THREADLOCAL int      heightunit = (1 << 12);
+static THREADLOCAL int      invhgtbits = 4;
 
 typedef struct
 {
@@ -162,7 +167,7 @@ static const scale_values_t scale_values[9] =
 
 void R_FixWiggle(sector_t *sector)
 {
-    static int  lastheight = 0;
+    static THREADLOCAL int      lastheight = 0;
 
     // disallow negative heights, force cache initialization
     int         height = MAX(1, (sector->interpceilingheight - sector->interpfloorheight) >> FRACBITS);
@@ -171,26 +176,19 @@ void R_FixWiggle(sector_t *sector)
     if (height != lastheight)
     {
         const scale_values_t    *svp;
+        int                     scaleindex = 0;
 
         lastheight = height;
 
-        // initialize, or handle moving sector
-        if (height != sector->cachedheight)
-        {
-            int scaleindex = 0;
-
-            sector->cachedheight = height;
-            height >>= 7;
+        // calculate adjustment (not cached in the sector, as it may be shared
+        // by several render threads)
+        height >>= 7;
 
-            // calculate adjustment
-            while ((height >>= 1))
-                scaleindex++;
-
-            sector->scaleindex = scaleindex;
-        }
+        while ((height >>= 1))
+            scaleindex++;
 
         // fine-tune renderer for this wall
-        svp = &scale_values[sector->scaleindex];
+        svp = &scale_values[scaleindex];
         max_rwscale = svp->clamp;
         heightbits = svp->heightbits;
         heightunit = (1 << heightbits);
@@ -198,7 +196,7 @@ void R_FixWiggle(sector_t *sector)
     }
 }
 
-static void R_DrawMaskedColumn(column_t *column)
+static void R_DrawMaskedColumn(colcontext_t *dc, column_t *column)
 {
     while (column->topdelta != 0xff)
     {
@@ -213,32 +211,32 @@ static void R_DrawMaskedColumn(column_t *column)
         // calculate unclipped screen coordinates for post
         topscreen = sprtopscreen + spryscale * column->topdelta + 1;
 
-        dc_yl = MAX((int)((topscreen + FRACUNIT) >> FRACBITS), mceilingclip[dc_x] + 1);
-        dc_yh = MIN((int)((topscreen + spryscale * column->length) >> FRACBITS), mfloorclip[dc_x] - 1);
+        dc->yl = MAX((int)((topscreen + FRACUNIT) >> FRACBITS), mceilingclip[dc->x] + 1);
+        dc->yh = MIN((int)((topscreen + spryscale * column->length) >> FRACBITS), mfloorclip[dc->x] - 1);
 
-        dc_texturefrac = dc_texturemid - (column->topdelta << FRACBITS) +
-            FixedMul((dc_yl - centery) << FRACBITS, dc_iscale);
+        dc->texturefrac = dc->texturemid - (column->topdelta << FRACBITS) +
+            FixedMul((dc->yl - centery) << FRACBITS, dc->iscale);
 
-        if (dc_texturefrac < 0)
+        if (dc->texturefrac < 0)
         {
-            int cnt = (FixedDiv(-dc_texturefrac, dc_iscale) + FRACUNIT - 1) >> FRACBITS;
+            int cnt = (FixedDiv(-dc->texturefrac, dc->iscale) + FRACUNIT - 1) >> FRACBITS;
 
-            dc_yl += cnt;
-            dc_texturefrac += cnt * dc_iscale;
+            dc->yl += cnt;
+            dc->texturefrac += cnt * dc->iscale;
         }
 
         {
-            const fixed_t       endfrac = dc_texturefrac + (dc_yh - dc_yl) * dc_iscale;
+            const fixed_t       endfrac = dc->texturefrac + (dc->yh - dc->yl) * dc->iscale;
             const fixed_t       maxfrac = column->length << FRACBITS;
 
             if (endfrac >= maxfrac)
-                dc_yh -= (FixedDiv(endfrac - maxfrac - 1, dc_iscale) + FRACUNIT - 1) >> FRACBITS;
+                dc->yh -= (FixedDiv(endfrac - maxfrac - 1, dc->iscale) + FRACUNIT - 1) >> FRACBITS;
         }
 
-        if (dc_yl >= 0 && dc_yh < viewheight && dc_yl <= dc_yh)
+        if (dc->yl >= 0 && dc->yh < viewheight && dc->yl <= dc->yh)
         {
-            dc_source = (byte *)column + 3;
-            colfunc();
+            dc->source = (byte *)column + 3;
+            colfunc(dc);
         }
 
         column = (column_t *)((byte *)column + column->length + 4);
@@ -250,10 +248,11 @@ static void R_DrawMaskedColumn(column_t *column)
 //
 void R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
 {
-    int         lightnum;
-    int         texnum;
-    fixed_t     texheight;
-    sector_t    tempsec;        // killough 4/13/98
+    int             lightnum;
+    int             texnum;
+    fixed_t         texheight;
+    sector_t        tempsec;    // killough 4/13/98
+    colcontext_t    dc;
 
     // Calculate light table.
     // Use different light tables for horizontal / vertical.
@@ -287,22 +286,22 @@ void R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
 
     // find positioning
     if (curline->linedef->flags & ML_DONTPEGBOTTOM)
-        dc_texturemid = MAX(frontsector->interpfloorheight, backsector->interpfloorheight)
+        dc.texturemid = MAX(frontsector->interpfloorheight, backsector->interpfloorheight)
             + texheight - viewz + curline->sidedef->rowoffset;
     else
-        dc_texturemid = MIN(frontsector->interpceilingheight, backsector->interpceilingheight)
+        dc.texturemid = MIN(frontsector->interpceilingheight, backsector->interpceilingheight)
             - viewz + curline->sidedef->rowoffset;
 
-    dc_colormap = fixedcolormap;
+    dc.colormap = fixedcolormap;
 
     // draw the columns
-    for (dc_x = x1; dc_x <= x2; ++dc_x, spryscale += rw_scalestep)
+    for (dc.x = x1; dc.x <= x2; ++dc.x, spryscale += rw_scalestep)
     {
         // calculate lighting
-        if (maskedtexturecol[dc_x] != INT_MAX)
+        if (maskedtexturecol[dc.x] != INT_MAX)
         {
             if (!fixedcolormap)
-                dc_colormap = walllights[BETWEEN(0, spryscale >> LIGHTSCALESHIFT,
+                dc.colormap = walllights[BETWEEN(0, spryscale >> LIGHTSCALESHIFT,
                     MAXLIGHTSCALE - 1)];
 
             // killough 3/2/98:
@@ -316,7 +315,7 @@ void R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
             // mapping to screen coordinates is totally out of range:
             {
                 int64_t     t = ((int64_t)centeryfrac << FRACBITS)
-                                - (int64_t)dc_texturemid * spryscale;
+                                - (int64_t)dc.texturemid * spryscale;
 
                 if (t + (int64_t)texheight * spryscale < 0
                     || t >(int64_t)SCREENHEIGHT << FRACBITS * 2)
@@ -325,12 +324,12 @@ void R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
                 sprtopscreen = (int64_t)(t >> FRACBITS);
             }
 
-            dc_iscale = 0xffffffffu / (unsigned int)spryscale;
+            dc.iscale = 0xffffffffu / (unsigned int)spryscale;
 
             // draw the texture
-            R_DrawMaskedColumn((column_t *)((byte *)R_GetColumn(texnum,
-                maskedtexturecol[dc_x]) - 3));
-            maskedtexturecol[dc_x] = INT_MAX;   // dropoff overflow
+            R_DrawMaskedColumn(&dc, (column_t *)((byte *)R_GetColumn(texnum,
+                maskedtexturecol[dc.x]) - 3));
+            maskedtexturecol[dc.x] = INT_MAX;   // dropoff overflow
         }
     }
 }
@@ -345,7 +344,8 @@ void R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
 //
 void R_RenderSegLoop(void)
 {
-    fixed_t     texturecolumn;
+    fixed_t         texturecolumn;
+    colcontext_t    dc;
 
     for (; rw_x < rw_stopx; ++rw_x)
     {
@@ -408,9 +408,9 @@ void R_RenderSegLoop(void)
 
             texturecolumn = (rw_offset - FixedMul(finetangent[angle], rw_distance)) >> FRACBITS;
 
-            dc_colormap = walllights[BETWEEN(0, rw_scale >> LIGHTSCALESHIFT, MAXLIGHTSCALE - 1)];
-            dc_x = rw_x;
-            dc_iscale = 0xffffffffu / (unsigned int)rw_scale;
+            dc.colormap = walllights[BETWEEN(0, rw_scale >> LIGHTSCALESHIFT, MAXLIGHTSCALE - 1)];
+            dc.x = rw_x;
+            dc.iscale = 0xffffffffu / (unsigned int)rw_scale;
         }
 
         // draw the wall tiers
@@ -419,25 +419,25 @@ void R_RenderSegLoop(void)
             //if (yl < viewheight && yh >= 0 && yh >= yl)
             {
                 // single sided line
-                dc_yl = yl;
-                dc_yh = yh;
+                dc.yl = yl;
+                dc.yh = yh;
 
                 // [BH] for "sparkle" hack
-                dc_topsparkle = false;
-                dc_bottomsparkle = (!bottomclipped && dc_yh > dc_yl
+                dc.topsparkle = false;
+                dc.bottomsparkle = (!bottomclipped && dc.yh > dc.yl
                     && rw_distance < (512 << FRACBITS));
 
-                dc_texturemid = rw_midtexturemid;
-                dc_source = R_GetColumn(midtexture, texturecolumn);
-                dc_texheight = midtexheight;
+                dc.texturemid = rw_midtexturemid;
+                dc.source = R_GetColumn(midtexture, texturecolumn);
+                dc.texheight = midtexheight;
 
                 // [BH] apply brightmap
-                dc_colormask = midtexfullbright;
+                dc.colormask = midtexfullbright;
 
-                if (dc_colormask && brightmaps)
-                    fbwallcolfunc();
+                if (dc.colormask && brightmaps)
+                    fbwallcolfunc(&dc);
                 else
-                    wallcolfunc();
+                    wallcolfunc(&dc);
             }
             ceilingclip[rw_x] = viewheight;
             floorclip[rw_x] = -1;
@@ -455,34 +455,34 @@ void R_RenderSegLoop(void)
                 if (mid >= floorclip[rw_x])
                 {
                     mid = floorclip[rw_x] - 1;
-                    dc_bottomsparkle = false;
+                    dc.bottomsparkle = false;
                 }
                 else
-                    dc_bottomsparkle = true;
+                    dc.bottomsparkle = true;
 
                 if (mid >= yl)
                 {
                     //if (yl < viewheight && mid >= 0)
                     {
-                        dc_yl = yl;
-                        dc_yh = mid;
+                        dc.yl = yl;
+                        dc.yh = mid;
 
                         // [BH] for "sparkle" hack
-                        dc_topsparkle = false;
-                        dc_bottomsparkle = (dc_bottomsparkle && dc_yh > dc_yl
+                        dc.topsparkle = false;
+                        dc.bottomsparkle = (dc.bottomsparkle && dc.yh > dc.yl
                             && rw_distance < (512 << FRACBITS));
 
-                        dc_texturemid = rw_toptexturemid;
-                        dc_source = R_GetColumn(toptexture, texturecolumn);
-                        dc_texheight = toptexheight;
+                        dc.texturemid = rw_toptexturemid;
+                        dc.source = R_GetColumn(toptexture, texturecolumn);
+                        dc.texheight = toptexheight;
 
                         // [BH] apply brightmap
-                        dc_colormask = toptexfullbright;
+                        dc.colormask = toptexfullbright;
 
-                        if (dc_colormask && brightmaps)
-                            fbwallcolfunc();
+                        if (dc.colormask && brightmaps)
+                            fbwallcolfunc(&dc);
                         else
-                            wallcolfunc();
+                            wallcolfunc(&dc);
                     }
                     ceilingclip[rw_x] = mid;
                 }
@@ -505,35 +505,35 @@ void R_RenderSegLoop(void)
                 if (mid <= ceilingclip[rw_x])
                 {
                     mid = ceilingclip[rw_x] + 1;
-                    dc_topsparkle = false;
+                    dc.topsparkle = false;
                 }
                 else
-                    dc_topsparkle = true;
+                    dc.topsparkle = true;
 
                 if (mid <= yh)
                 {
                     //if (mid < viewheight && yh >= 0)
                     {
-                        dc_yl = mid;
-                        dc_yh = yh;
+                        dc.yl = mid;
+                        dc.yh = yh;
 
                         // [BH] for "sparkle" hack
-                        dc_topsparkle = (dc_topsparkle && dc_yh > dc_yl
+                        dc.topsparkle = (dc.topsparkle && dc.yh > dc.yl
                             && rw_distance < (128 << FRACBITS));
-                        dc_bottomsparkle = (!bottomclipped && dc_yh > dc_yl
+                        dc.bottomsparkle = (!bottomclipped && dc.yh > dc.yl
                             && rw_distance < (512 << FRACBITS));
 
-                        dc_texturemid = rw_bottomtexturemid;
-                        dc_source = R_GetColumn(bottomtexture, texturecolumn);
-                        dc_texheight = bottomtexheight;
+                        dc.texturemid = rw_bottomtexturemid;
+                        dc.source = R_GetColumn(bottomtexture, texturecolumn);
+                        dc.texheight = bottomtexheight;
 
                         // [BH] apply brightmap
-                        dc_colormask = bottomtexfullbright;
+                        dc.colormask = bottomtexfullbright;
 
-                        if (dc_colormask && brightmaps)
-                            fbwallcolfunc();
+                        if (dc.colormask && brightmaps)
+                            fbwallcolfunc(&dc);
                         else
-                            wallcolfunc();
+                            wallcolfunc(&dc);
                     }
                     floorclip[rw_x] = mid;
                 }
@@ -572,6 +572,21 @@ static fixed_t R_ScaleFromGlobalAngle(angle_t visangle)
     return (den > (num >> 16) ? BETWEEN(256, FixedDiv(num, den), max_rwscale) : max_rwscale);
 }
 
+//
+// R_MarkMappedLines
+// Marks the lines seen by the first strip as visible for the automap, once
+//  every strip has been rendered.
+//
+void R_MarkMappedLines(void)
+{
+    int i;
+
+    for (i = 0; i < nummappedlines; i++)
+        mappedlines[i]->flags |= ML_MAPPED;
+
+    nummappedlines = 0;
+}
+
 //
 // R_StoreWallRange
 // A wall segment will be drawn
@@ -580,16 +595,36 @@ static fixed_t R_ScaleFromGlobalAngle(angle_t visangle)
 void R_StoreWallRange(int start, int stop)
 {
     int64_t     dx, dy, dx1, dy1, len;
+    int         skip;
 
     linedef = curline->linedef;
 
-    // mark the segment as visible for automap
-    linedef->flags |= ML_MAPPED;
+    // mark the segment as visible for automap (only once, by the first strip).
+    //  The other strips may be reading the line's flags while the view is
+    //  rendered, so it's only noted until R_MarkMappedLines() is called.
+    if (!stripx1 && !(linedef->flags & ML_MAPPED))
+    {
+        if (automapactive)
+            linedef->flags |= ML_MAPPED;
+        else
+        {
+            if (nummappedlines == maxmappedlines)
+            {
+                maxmappedlines = (maxmappedlines ? 2 * maxmappedlines : 256);
+                mappedlines = realloc(mappedlines, maxmappedlines * sizeof(*mappedlines));
+            }
+            mappedlines[nummappedlines++] = linedef;
+        }
+    }
 
     // [BH] if in automap, we're done now that line is mapped
     if (automapactive)
         return;
 
+    // nothing to draw in this render thread's strip?
+    if (stop < stripx1 || start > stripx2)
+        return;
+
     sidedef = curline->sidedef;
 
     // killough 1/98 -- fix 2s line HOM
@@ -615,17 +650,21 @@ void R_StoreWallRange(int start, int stop)
     len = curline->length;
     rw_distance = (fixed_t)((dy * dx1 - dx * dy1) / len);
 
-    ds_p->x1 = rw_x = start;
+    // the drawseg covers the whole range, so scales are calculated exactly as
+    //  they would be without strips, but only columns in the strip are drawn
+    ds_p->x1 = start;
     ds_p->x2 = stop;
     ds_p->curline = curline;
-    rw_stopx = stop + 1;
+    rw_x = MAX(start, stripx1);
+    rw_stopx = MIN(stop, stripx2) + 1;
+    skip = rw_x - start;
 
     // killough 1/6/98, 2/1/98: remove limit on openings
     {
-        extern int      *openings;              // dropoff overflow
-        extern size_t   maxopenings;
+        extern THREADLOCAL int      *openings;  // dropoff overflow
+        extern THREADLOCAL size_t   maxopenings;
         size_t          pos = lastopening - openings;
-        size_t          need = (rw_stopx - start) * sizeof(*lastopening) + pos;
+        size_t          need = (rw_stopx - rw_x) * sizeof(*lastopening) + pos;
 
         if (need > maxopenings)
         {
@@ -644,14 +683,16 @@ void R_StoreWallRange(int start, int stop)
             //    were already stored in drawsegs.
             for (ds = drawsegs; ds < ds_p; ds++)
             {
-                if (ds->maskedtexturecol + ds->x1 >= oldopenings
-                    && ds->maskedtexturecol + ds->x1 <= oldlast)
+                int     x = MAX(ds->x1, stripx1);
+
+                if (ds->maskedtexturecol + x >= oldopenings
+                    && ds->maskedtexturecol + x <= oldlast)
                     ds->maskedtexturecol = ds->maskedtexturecol - oldopenings + openings;
-                if (ds->sprtopclip + ds->x1 >= oldopenings
-                    && ds->sprtopclip + ds->x1 <= oldlast)
+                if (ds->sprtopclip + x >= oldopenings
+                    && ds->sprtopclip + x <= oldlast)
                     ds->sprtopclip = ds->sprtopclip - oldopenings + openings;
-                if (ds->sprbottomclip + ds->x1 >= oldopenings
-                    && ds->sprbottomclip + ds->x1 <= oldlast)
+                if (ds->sprbottomclip + x >= oldopenings
+                    && ds->sprbottomclip + x <= oldlast)
                     ds->sprbottomclip = ds->sprbottomclip - oldopenings + openings;
             }
         }
@@ -748,7 +789,7 @@ void R_StoreWallRange(int start, int stop)
         //
         // killough 4/7/98: make doorclosed external variable
         {
-            extern boolean      doorclosed;
+            extern THREADLOCAL boolean  doorclosed;
 
             if (doorclosed || backsector->interpceilingheight <= frontsector->interpfloorheight)
             {
@@ -929,6 +970,7 @@ void R_StoreWallRange(int start, int stop)
             pixhigh = ((int64_t)centeryfrac >> invhgtbits)
                 - (((int64_t)worldhigh * rw_scale) >> FRACBITS);
             pixhighstep = -FixedMul(rw_scalestep, worldhigh);
+            pixhigh += (int64_t)skip * pixhighstep;
         }
 
         if (worldlow > worldbottom)
@@ -936,9 +978,18 @@ void R_StoreWallRange(int start, int stop)
             pixlow = ((int64_t)centeryfrac >> invhgtbits)
                 - (((int64_t)worldlow * rw_scale) >> FRACBITS);
             pixlowstep = -FixedMul(rw_scalestep, worldlow);
+            pixlow += (int64_t)skip * pixlowstep;
         }
     }
 
+    // step to the first column of the strip
+    if (skip)
+    {
+        rw_scale += skip * rw_scalestep;
+        topfrac += (int64_t)skip * topstep;
+        bottomfrac += (int64_t)skip * bottomstep;
+    }
+
     // render it
     if (markceiling)
         if (ceilingplane)   // killough 4/11/98: add NULL ptr checks
@@ -954,6 +1005,9 @@ void R_StoreWallRange(int start, int stop)
 
     R_RenderSegLoop();
 
+    // only the columns in the strip are saved
+    start += skip;
+
     // save sprite clipping info
     if (((ds_p->silhouette & SIL_TOP) || maskedtexture) && !ds_p->sprtopclip)
     {
@@ -40,5 +40,6 @@
 #define __R_SEGS__
 
 void R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2);
+void R_MarkMappedLines(void);
 
 #endif
@@ -45,6 +45,7 @@
 int skyflatnum;
 int skytexture;
 int skytexturemid;
+fixed_t skyiscale;
 
 //
 // R_InitSkyMap
@@ -47,6 +47,7 @@
 
 extern int              skytexture;
 extern int              skytexturemid;
+extern fixed_t          skyiscale;
 
 // Called whenever the view size changes.
 void R_InitSkyMap(void);
@@ -66,6 +66,7 @@ extern lighttable_t     *fullcolormap;  // killough 3/20/98
 extern int              viewwidth;
 extern int              scaledviewwidth;
 extern int              viewheight;
+extern int              scaledviewheight;
 
 extern int              firstflat;
 
@@ -123,9 +124,9 @@ extern angle_t          clipangle;
 extern int              viewangletox[FINEANGLES / 2];
 extern angle_t          xtoviewangle[SCREENWIDTH + 1];
 
-extern angle_t          rw_normalangle;
+extern THREADLOCAL angle_t          rw_normalangle;
 
-extern visplane_t       *floorplane;
-extern visplane_t       *ceilingplane;
+extern THREADLOCAL visplane_t       *floorplane;
+extern THREADLOCAL visplane_t       *ceilingplane;
 
 #endif
@@ -40,6 +40,8 @@
 #include "doomstat.h"
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_timer.h"
+#include "m_misc.h"
 #include "p_local.h"
 #include "v_video.h"
 #include "w_wad.h"
@@ -59,7 +61,7 @@ fixed_t                         pspritexscale;
 fixed_t                         pspriteyscale;
 fixed_t                         pspriteiscale;
 
-static lighttable_t             **spritelights;         // killough 1/25/98 made static
+static THREADLOCAL lighttable_t             **spritelights;         // killough 1/25/98 made static
 
 // constant arrays
 //  used for psprite clipping and initializing clipping
@@ -255,8 +257,13 @@ void R_InitSpriteDefs(char **namelist)
 //
 // GAME FUNCTIONS
 //
-static vissprite_t      *vissprites, **vissprite_ptrs;          // killough
-static int              num_vissprite, num_vissprite_alloc, num_vissprite_ptrs;
+static THREADLOCAL vissprite_t      *vissprites, **vissprite_ptrs;          // killough
+static THREADLOCAL int              num_vissprite, num_vissprite_alloc, num_vissprite_ptrs;
+
+// sectors whose things have been added this frame, kept per render thread
+// rather than in sector_t::validcount
+static THREADLOCAL int              *sectorvalidcount;
+static THREADLOCAL int              numsectorvalidcount;
 
 //
 // R_InitSprites
@@ -279,6 +286,14 @@ void R_InitSprites(char **namelist)
 void R_ClearSprites(void)
 {
     num_vissprite = 0;          // killough
+
+    if (numsectors > numsectorvalidcount)
+    {
+        sectorvalidcount = realloc(sectorvalidcount, numsectors * sizeof(*sectorvalidcount));
+        memset(sectorvalidcount + numsectorvalidcount, 0,
+            (numsectors - numsectorvalidcount) * sizeof(*sectorvalidcount));
+        numsectorvalidcount = numsectors;
+    }
 }
 
 //
@@ -300,14 +315,14 @@ vissprite_t *R_NewVisSprite(void)
 // Masked means: partly transparent, i.e. stored
 //  in posts/runs of opaque pixels.
 //
-int     *mfloorclip;
-int     *mceilingclip;
+THREADLOCAL int     *mfloorclip;
+THREADLOCAL int     *mceilingclip;
 
-fixed_t spryscale;
-int64_t sprtopscreen;
-int64_t shift;
+THREADLOCAL fixed_t spryscale;
+THREADLOCAL int64_t sprtopscreen;
+THREADLOCAL int64_t shift;
 
-static void R_DrawMaskedSpriteColumn(column_t *column)
+static void R_DrawMaskedSpriteColumn(colcontext_t *dc, column_t *column)
 {
     while (column->topdelta != 0xff)
     {
@@ -317,41 +332,41 @@ static void R_DrawMaskedSpriteColumn(column_t *column)
         // calculate unclipped screen coordinates for post
         int64_t topscreen = sprtopscreen + spryscale * topdelta + 1;
 
-        dc_yl = MAX((int)((topscreen + FRACUNIT) >> FRACBITS), mceilingclip[dc_x] + 1);
-        dc_yh = MIN((int)((topscreen + spryscale * length) >> FRACBITS), mfloorclip[dc_x] - 1);
+        dc->yl = MAX((int)((topscreen + FRACUNIT) >> FRACBITS), mceilingclip[dc->x] + 1);
+        dc->yh = MIN((int)((topscreen + spryscale * length) >> FRACBITS), mfloorclip[dc->x] - 1);
 
-        if (dc_baseclip != -1)
-            dc_yh = MIN(dc_baseclip, dc_yh);
+        if (dc->baseclip != -1)
+            dc->yh = MIN(dc->baseclip, dc->yh);
 
-        dc_texturefrac = dc_texturemid - (topdelta << FRACBITS)
-            + FixedMul((dc_yl - centery) << FRACBITS, dc_iscale);
+        dc->texturefrac = dc->texturemid - (topdelta << FRACBITS)
+            + FixedMul((dc->yl - centery) << FRACBITS, dc->iscale);
 
-        if (dc_texturefrac < 0)
+        if (dc->texturefrac < 0)
         {
-            int cnt = (FixedDiv(-dc_texturefrac, dc_iscale) + FRACUNIT - 1) >> FRACBITS;
+            int cnt = (FixedDiv(-dc->texturefrac, dc->iscale) + FRACUNIT - 1) >> FRACBITS;
 
-            dc_yl += cnt;
-            dc_texturefrac += cnt * dc_iscale;
+            dc->yl += cnt;
+            dc->texturefrac += cnt * dc->iscale;
         }
 
         {
-            const fixed_t       endfrac = dc_texturefrac + (dc_yh - dc_yl) * dc_iscale;
+            const fixed_t       endfrac = dc->texturefrac + (dc->yh - dc->yl) * dc->iscale;
             const fixed_t       maxfrac = length << FRACBITS;
 
             if (endfrac >= maxfrac)
-                dc_yh -= (FixedDiv(endfrac - maxfrac - 1, dc_iscale) + FRACUNIT - 1) >> FRACBITS;
+                dc->yh -= (FixedDiv(endfrac - maxfrac - 1, dc->iscale) + FRACUNIT - 1) >> FRACBITS;
         }
 
-        if (dc_yl <= dc_yh && dc_yh < viewheight)
+        if (dc->yl <= dc->yh && dc->yh < viewheight)
         {
-            dc_source = (byte *)column + 3;
-            colfunc();
+            dc->source = (byte *)column + 3;
+            colfunc(dc);
         }
         column = (column_t *)((byte *)column + length + 4);
     }
 }
 
-static void R_DrawMaskedBloodSplatColumn(column_t *column)
+static void R_DrawMaskedBloodSplatColumn(colcontext_t *dc, column_t *column)
 {
     while (column->topdelta != 0xff)
     {
@@ -360,19 +375,19 @@ static void R_DrawMaskedBloodSplatColumn(column_t *column)
         // calculate unclipped screen coordinates for post
         int64_t topscreen = sprtopscreen + spryscale * column->topdelta + 1;
 
-        dc_yl = MAX((int)((topscreen + FRACUNIT) >> FRACBITS), mceilingclip[dc_x] + 1);
-        dc_yh = MIN((int)((topscreen + spryscale * length) >> FRACBITS), mfloorclip[dc_x] - 1);
+        dc->yl = MAX((int)((topscreen + FRACUNIT) >> FRACBITS), mceilingclip[dc->x] + 1);
+        dc->yh = MIN((int)((topscreen + spryscale * length) >> FRACBITS), mfloorclip[dc->x] - 1);
 
-        if (dc_yl <= dc_yh && dc_yh < viewheight)
+        if (dc->yl <= dc->yh && dc->yh < viewheight)
         {
-            dc_source = (byte *)column + 3;
-            colfunc();
+            dc->source = (byte *)column + 3;
+            colfunc(dc);
         }
         column = (column_t *)((byte *)column + length + 4);
     }
 }
 
-static void R_DrawMaskedShadowColumn(column_t *column)
+static void R_DrawMaskedShadowColumn(colcontext_t *dc, column_t *column)
 {
     while (column->topdelta != 0xff)
     {
@@ -381,46 +396,45 @@ static void R_DrawMaskedShadowColumn(column_t *column)
         // calculate unclipped screen coordinates for post
         int64_t topscreen = sprtopscreen + spryscale * column->topdelta + 1;
 
-        dc_yl = MAX((int)(((topscreen + FRACUNIT) >> FRACBITS) / 10 + shift), mceilingclip[dc_x] + 1);
-        dc_yh = MIN((int)(((topscreen + spryscale * length) >> FRACBITS) / 10 + shift),
-            mfloorclip[dc_x] - 1);
+        dc->yl = MAX((int)(((topscreen + FRACUNIT) >> FRACBITS) / 10 + shift), mceilingclip[dc->x] + 1);
+        dc->yh = MIN((int)(((topscreen + spryscale * length) >> FRACBITS) / 10 + shift),
+            mfloorclip[dc->x] - 1);
 
-        if (dc_yl <= dc_yh && dc_yh < viewheight)
+        if (dc->yl <= dc->yh && dc->yh < viewheight)
         {
-            dc_source = (byte *)column + 3;
-            colfunc();
+            dc->source = (byte *)column + 3;
+            colfunc(dc);
         }
         column = (column_t *)((byte *)column + length + 4);
     }
 }
 
-int     fuzzpos;
-
 //
 // R_DrawVisSprite
 //  mfloorclip and mceilingclip should also be set.
 //
 void R_DrawVisSprite(vissprite_t *vis)
 {
-    fixed_t     frac = vis->startfrac;
-    fixed_t     xiscale = vis->xiscale;
-    fixed_t     x2 = vis->x2;
-    patch_t     *patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    fixed_t         frac = vis->startfrac;
+    fixed_t         xiscale = vis->xiscale;
+    fixed_t         x2 = vis->x2;
+    patch_t         *patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    colcontext_t    dc;
 
-    dc_colormap = vis->colormap;
+    dc.colormap = vis->colormap;
     colfunc = vis->colfunc;
 
-    dc_iscale = ABS(xiscale);
-    dc_texturemid = vis->texturemid;
+    dc.iscale = FixedDiv(FRACUNIT, vis->scale);
+    dc.texturemid = vis->texturemid;
     if (vis->mobjflags & MF_TRANSLATION)
     {
         colfunc = transcolfunc;
-        dc_translation = translationtables - 256
+        dc.translation = translationtables - 256
             + ((vis->mobjflags & MF_TRANSLATION) >> (MF_TRANSSHIFT - 8));
     }
 
     spryscale = vis->scale;
-    sprtopscreen = centeryfrac - FixedMul(dc_texturemid, spryscale);
+    sprtopscreen = centeryfrac - FixedMul(dc.texturemid, spryscale);
 
     if (viewplayer->fixedcolormap == INVERSECOLORMAP && translucency)
     {
@@ -437,15 +451,13 @@ void R_DrawVisSprite(vissprite_t *vis)
     }
 
     if (vis->footclip)
-        dc_baseclip = ((int)sprtopscreen + FixedMul(SHORT(patch->height) << FRACBITS, spryscale)
+        dc.baseclip = ((int)sprtopscreen + FixedMul(SHORT(patch->height) << FRACBITS, spryscale)
             - FixedMul(vis->footclip, spryscale)) >> FRACBITS;
     else
-        dc_baseclip = -1;
+        dc.baseclip = -1;
 
-    fuzzpos = 0;
-
-    for (dc_x = vis->x1; dc_x <= x2; dc_x++, frac += xiscale)
-        R_DrawMaskedSpriteColumn((column_t *)((byte *)patch
+    for (dc.x = vis->x1; dc.x <= x2; dc.x++, frac += xiscale)
+        R_DrawMaskedSpriteColumn(&dc, (column_t *)((byte *)patch
             + LONG(patch->columnofs[frac >> FRACBITS])));
 
     colfunc = basecolfunc;
@@ -453,22 +465,22 @@ void R_DrawVisSprite(vissprite_t *vis)
 
 void R_DrawBloodSplatVisSprite(vissprite_t *vis)
 {
-    fixed_t     frac = vis->startfrac;
-    fixed_t     xiscale = vis->xiscale;
-    fixed_t     x2 = vis->x2;
-    patch_t     *patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    fixed_t         frac = vis->startfrac;
+    fixed_t         xiscale = vis->xiscale;
+    fixed_t         x2 = vis->x2;
+    patch_t         *patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    colcontext_t    dc;
 
     colfunc = vis->colfunc;
 
-    dc_blood = vis->colormap[vis->blood] << 8;
+    dc.blood = vis->colormap[vis->blood] << 8;
+    dc.baseclip = -1;
 
     spryscale = vis->scale;
     sprtopscreen = centeryfrac - FixedMul(vis->texturemid, spryscale);
 
-    fuzzpos = 0;
-
-    for (dc_x = vis->x1; dc_x <= x2; dc_x++, frac += xiscale)
-        R_DrawMaskedBloodSplatColumn((column_t *)((byte *)patch
+    for (dc.x = vis->x1; dc.x <= x2; dc.x++, frac += xiscale)
+        R_DrawMaskedBloodSplatColumn(&dc, (column_t *)((byte *)patch
             + LONG(patch->columnofs[frac >> FRACBITS])));
 
     colfunc = basecolfunc;
@@ -476,10 +488,11 @@ void R_DrawBloodSplatVisSprite(vissprite_t *vis)
 
 void R_DrawShadowVisSprite(vissprite_t *vis)
 {
-    fixed_t     frac = vis->startfrac;
-    fixed_t     xiscale = vis->xiscale;
-    fixed_t     x2 = vis->x2;
-    patch_t     *patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    fixed_t         frac = vis->startfrac;
+    fixed_t         xiscale = vis->xiscale;
+    fixed_t         x2 = vis->x2;
+    patch_t         *patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    colcontext_t    dc;
 
     colfunc = vis->colfunc;
 
@@ -487,8 +500,8 @@ void R_DrawShadowVisSprite(vissprite_t *vis)
     sprtopscreen = centeryfrac - FixedMul(vis->texturemid, spryscale);
     shift = (sprtopscreen * 9 / 10) >> FRACBITS;
 
-    for (dc_x = vis->x1; dc_x <= x2; dc_x++, frac += xiscale)
-        R_DrawMaskedShadowColumn((column_t *)((byte *)patch
+    for (dc.x = vis->x1; dc.x <= x2; dc.x++, frac += xiscale)
+        R_DrawMaskedShadowColumn(&dc, (column_t *)((byte *)patch
             + LONG(patch->columnofs[frac >> FRACBITS])));
 
     colfunc = basecolfunc;
@@ -504,6 +517,7 @@ void R_ProjectSprite(mobj_t *thing)
     fixed_t             tx;
 
     fixed_t             xscale;
+    fixed_t             yscale;
 
     int                 x1;
     int                 x2;
@@ -600,20 +614,21 @@ void R_ProjectSprite(mobj_t *thing)
     tx -= (flip ? spritewidth[lump] - spriteoffset[lump] : spriteoffset[lump]);
     x1 = (centerxfrac + FRACUNIT / 2 + FixedMul(tx, xscale)) >> FRACBITS;
 
-    // off the right side?
-    if (x1 > viewwidth)
+    // off the right side of the strip?
+    if (x1 > stripx2)
         return;
 
     x2 = ((centerxfrac + FRACUNIT / 2 + FixedMul(tx + spritewidth[lump], xscale)) >> FRACBITS) - 1;
 
-    // off the left side
-    if (x2 < 0)
+    // off the left side of the strip?
+    if (x2 < stripx1)
         return;
 
     gzt = interpz + spritetopoffset[lump];
+    yscale = FixedDiv(projectiony, tz);
 
-    if (interpz > viewz + FixedDiv(viewheight << FRACBITS, xscale)
-        || gzt < viewz - FixedDiv((viewheight << FRACBITS) - viewheight, xscale))
+    if (interpz > viewz + FixedDiv(viewheight << FRACBITS, yscale)
+        || gzt < viewz - FixedDiv((viewheight << FRACBITS) - viewheight, yscale))
         return;
 
     // killough 3/27/98: exclude things totally separated
@@ -645,7 +660,7 @@ void R_ProjectSprite(mobj_t *thing)
     vis->mobjflags = flags;
     vis->mobjflags2 = flags2;
     vis->type = type;
-    vis->scale = xscale;
+    vis->scale = yscale;
     vis->gx = interpx;
     vis->gy = interpy;
     vis->gz = interpz;
@@ -676,8 +691,8 @@ void R_ProjectSprite(mobj_t *thing)
         vis->texturemid = gzt - viewz;
     }
 
-    vis->x1 = MAX(0, x1);
-    vis->x2 = MIN(x2, viewwidth - 1);
+    vis->x1 = MAX(stripx1, x1);
+    vis->x2 = MIN(x2, stripx2);
 
     if (flip)
     {
@@ -761,14 +776,14 @@ void R_ProjectBloodSplat(mobj_t *thing)
     tx -= (flip ? spritewidth[lump] - spriteoffset[lump] : spriteoffset[lump]);
     x1 = (centerxfrac + FRACUNIT / 2 + FixedMul(tx, xscale)) >> FRACBITS;
 
-    // off the right side?
-    if (x1 > viewwidth)
+    // off the right side of the strip?
+    if (x1 > stripx2)
         return;
 
     x2 = ((centerxfrac + FRACUNIT / 2 + FixedMul(tx + spritewidth[lump], xscale)) >> FRACBITS) - 1;
 
-    // off the left side
-    if (x2 < 0)
+    // off the left side of the strip?
+    if (x2 < stripx1)
         return;
 
     gzt = fz + spritetopoffset[lump];
@@ -802,7 +817,7 @@ void R_ProjectBloodSplat(mobj_t *thing)
     vis->mobjflags = flags;
     vis->mobjflags2 = flags2;
     vis->type = MT_BLOODSPLAT;
-    vis->scale = xscale;
+    vis->scale = FixedDiv(projectiony, tz);
     vis->gx = fx;
     vis->gy = fy;
     vis->gz = fz;
@@ -816,8 +831,8 @@ void R_ProjectBloodSplat(mobj_t *thing)
 
     vis->texturemid = gzt - viewz;
 
-    vis->x1 = MAX(0, x1);
-    vis->x2 = MIN(x2, viewwidth - 1);
+    vis->x1 = MAX(stripx1, x1);
+    vis->x2 = MIN(x2, stripx2);
 
     if (flip)
     {
@@ -909,14 +924,14 @@ void R_ProjectShadow(mobj_t *thing)
     tx -= (flip ? spritewidth[lump] - spriteoffset[lump] : spriteoffset[lump]);
     x1 = (centerxfrac + FRACUNIT / 2 + FixedMul(tx, xscale)) >> FRACBITS;
 
-    // off the right side?
-    if (x1 > viewwidth)
+    // off the right side of the strip?
+    if (x1 > stripx2)
         return;
 
     x2 = ((centerxfrac + FRACUNIT / 2 + FixedMul(tx + spritewidth[lump], xscale)) >> FRACBITS) - 1;
 
-    // off the left side
-    if (x2 < 0)
+    // off the left side of the strip?
+    if (x2 < stripx1)
         return;
 
     gzt = fz + spritetopoffset[lump];
@@ -950,7 +965,7 @@ void R_ProjectShadow(mobj_t *thing)
     vis->mobjflags = 0;
     vis->mobjflags2 = 0;
     vis->type = MT_SHADOW;
-    vis->scale = xscale;
+    vis->scale = FixedDiv(projectiony, tz);
     vis->gx = fx;
     vis->gy = fy;
     vis->gz = fz;
@@ -958,8 +973,8 @@ void R_ProjectShadow(mobj_t *thing)
     vis->colfunc = thing->colfunc;
     vis->texturemid = fz - viewz;
 
-    vis->x1 = MAX(0, x1);
-    vis->x2 = MIN(x2, viewwidth - 1);
+    vis->x1 = MAX(stripx1, x1);
+    vis->x2 = MIN(x2, stripx2);
 
     if (flip)
     {
@@ -991,11 +1006,11 @@ void R_AddSprites(sector_t *sec, int lightlevel)
     // A sector might have been split into several
     //  subsectors during BSP building.
     // Thus we check whether its already added.
-    if (sec->validcount == validcount)
+    if (sectorvalidcount[sec - sectors] == validcount)
         return;
 
     // Well, now it will be done.
-    sec->validcount = validcount;
+    sectorvalidcount[sec - sectors] = validcount;
 
     spritelights = scalelight[BETWEEN(0, (lightlevel >> LIGHTSEGSHIFT) + extralight * LIGHTBRIGHT,
         LIGHTLEVELS - 1)];
@@ -1112,7 +1127,7 @@ static void R_DrawPSprite(pspdef_t *psp, boolean invisibility)
             vis->colfunc = R_DrawSuperShotgunColumn;
         else
         {
-            void (*colfuncs[])(void) =
+            void (*colfuncs[])(colcontext_t *) =
             {
                 /* n/a      */ NULL,
                 /* SPR_SHTG */ basecolfunc,
@@ -1158,7 +1173,7 @@ static void R_DrawPSprite(pspdef_t *psp, boolean invisibility)
 //
 // R_DrawPlayerSprites
 //
-static void R_DrawPlayerSprites(void)
+void R_DrawPlayerSprites(void)
 {
     int         i;
     int         invisibility = viewplayer->powers[pw_invisibility];
@@ -1214,7 +1229,9 @@ static void msort(vissprite_t **s, vissprite_t **t, int n)
         msort(s1, t, n1);
         msort(s2, t, n2);
 
-        while ((*s1)->scale > (*s2)->scale ? (*d++ = *s1++, --n1) : (*d++ = *s2++, --n2));
+        // keep sprites of equal scale in the order they were projected, so each
+        // render thread sorts its share of them the same way
+        while ((*s1)->scale >= (*s2)->scale ? (*d++ = *s1++, --n1) : (*d++ = *s2++, --n2));
 
         if (n2)
             bcopyp(d, s2, n2);
@@ -1242,6 +1259,68 @@ static void msort(vissprite_t **s, vissprite_t **t, int n)
     }
 }
 
+// Sorts by scale, largest first, in the same order as msort
+#define RADIXKEY(spr)   ((unsigned int)(spr)->scale ^ 0x7fffffff)
+
+// Below this many vissprites, msort is faster than rsort
+#define RADIXSORTMIN    512
+
+//
+// rsort
+// Stable LSD radix sort of n vissprites in s on their scale, one byte at a
+//  time, using t as scratch space. All four counts are made in one pass,
+//  and a byte that is the same for every vissprite is skipped.
+//
+static void rsort(vissprite_t **s, vissprite_t **t, int n)
+{
+    int                 count[4][256];
+    vissprite_t         **src = s;
+    vissprite_t         **dest = t;
+    int                 pass;
+    int                 i;
+
+    memset(count, 0, sizeof(count));
+
+    for (i = 0; i < n; i++)
+    {
+        unsigned int    key = RADIXKEY(s[i]);
+
+        count[0][key & 255]++;
+        count[1][(key >> 8) & 255]++;
+        count[2][(key >> 16) & 255]++;
+        count[3][key >> 24]++;
+    }
+
+    for (pass = 0; pass < 4; pass++)
+    {
+        int             *c = count[pass];
+        int             shift = pass * 8;
+        int             total = 0;
+        vissprite_t     **temp;
+
+        if (c[(RADIXKEY(s[0]) >> shift) & 255] == n)
+            continue;
+
+        for (i = 0; i < 256; i++)
+        {
+            int         num = c[i];
+
+            c[i] = total;
+            total += num;
+        }
+
+        for (i = 0; i < n; i++)
+            dest[c[(RADIXKEY(src[i]) >> shift) & 255]++] = src[i];
+
+        temp = src;
+        src = dest;
+        dest = temp;
+    }
+
+    if (src != s)
+        bcopyp(s, src, n);
+}
+
 void R_SortVisSprites(void)
 {
     if (num_vissprite)
@@ -1268,7 +1347,69 @@ void R_SortVisSprites(void)
 
         // killough 9/22/98: replace qsort with merge sort, since the keys
         // are roughly in order to begin with, due to BSP rendering.
-        msort(vissprite_ptrs, vissprite_ptrs + num_vissprite, num_vissprite);
+        if (num_vissprite < RADIXSORTMIN)
+            msort(vissprite_ptrs, vissprite_ptrs + num_vissprite, num_vissprite);
+        else
+            rsort(vissprite_ptrs, vissprite_ptrs + num_vissprite, num_vissprite);
+    }
+}
+
+//
+// R_BenchmarkSortVisSprites
+// Times msort and rsort on the vissprites of the last frame rendered, and
+//  on copies of them enlarged to stand in for much busier maps.
+//
+void R_BenchmarkSortVisSprites(int runs)
+{
+    int                 n;
+
+    if (!num_vissprite)
+    {
+        C_Output("There are no vissprites to sort.");
+        return;
+    }
+
+    for (n = num_vissprite; n <= 16384; n *= 4)
+    {
+        vissprite_t     *sprites = malloc(n * sizeof(*sprites));
+        vissprite_t     **ptrs = malloc(n * 4 * sizeof(*ptrs));
+        vissprite_t     **msorted = ptrs;
+        vissprite_t     **rsorted = ptrs + n * 2;
+        uint64_t        start;
+        uint64_t        mtime;
+        uint64_t        rtime;
+        int             i;
+        int             j;
+
+        // repeat the captured vissprites, as if the same scene were visible
+        //  through several windows
+        for (i = 0; i < n; i++)
+            sprites[i] = vissprites[i % num_vissprite];
+
+        start = I_GetTimeUS();
+        for (j = 0; j < runs; j++)
+        {
+            for (i = 0; i < n; i++)
+                msorted[i] = sprites + i;
+            msort(msorted, msorted + n, n);
+        }
+        mtime = I_GetTimeUS() - start;
+
+        start = I_GetTimeUS();
+        for (j = 0; j < runs; j++)
+        {
+            for (i = 0; i < n; i++)
+                rsorted[i] = sprites + i;
+            rsort(rsorted, rsorted + n, n);
+        }
+        rtime = I_GetTimeUS() - start;
+
+        C_Output("%s vissprites: msort %.1f us, rsort %.1f us%s.", commify(n),
+            (double)mtime / runs, (double)rtime / runs,
+            (memcmp(msorted, rsorted, n * sizeof(*ptrs)) ? " (different order)" : ""));
+
+        free(sprites);
+        free(ptrs);
     }
 }
 
@@ -1647,9 +1788,5 @@ void R_DrawMasked(void)
     // render any remaining masked mid textures
     for (ds = ds_p; ds-- > drawsegs;)
         if (ds->maskedtexturecol)
-            R_RenderMaskedSegRange(ds, ds->x1, ds->x2);
-
-    // draw the psprites on top of everything
-    if (!inhelpscreens)
-        R_DrawPlayerSprites();
+            R_RenderMaskedSegRange(ds, MAX(ds->x1, stripx1), MIN(ds->x2, stripx2));
 }
@@ -45,10 +45,10 @@ extern int      negonearray[SCREENWIDTH];
 extern int      screenheightarray[SCREENWIDTH];
 
 // vars for R_DrawMaskedColumn
-extern int      *mfloorclip;
-extern int      *mceilingclip;
-extern fixed_t  spryscale;
-extern int64_t  sprtopscreen;
+extern THREADLOCAL int      *mfloorclip;
+extern THREADLOCAL int      *mceilingclip;
+extern THREADLOCAL fixed_t  spryscale;
+extern THREADLOCAL int64_t  sprtopscreen;
 
 extern fixed_t  pspritexscale;
 extern fixed_t  pspriteyscale;
@@ -58,12 +58,16 @@ extern fixed_t  viewheightfrac;
 
 void R_SortVisSprites(void);
 
+// Times the two ways R_SortVisSprites sorts vissprites.
+void R_BenchmarkSortVisSprites(int runs);
+
 void R_AddSprites(sector_t *sec, int lightlevel);
 void R_AddPSprites(void);
 void R_DrawSprites(void);
 void R_InitSprites(char **namelist);
 void R_ClearSprites(void);
 void R_DrawMasked(void);
+void R_DrawPlayerSprites(void);
 
 void R_ClipVisSprite(vissprite_t *vis, int xl, int xh);
 
@@ -315,19 +315,13 @@ void S_StopSounds(void)
 }
 
 //
-// Per level startup code.
-// Kills playing sounds at start of level,
-//  determines music if any, changes music.
+// S_GetMusicNum
+// Returns the music played on a map.
 //
-void S_Start(void)
+int S_GetMusicNum(int episode, int map)
 {
     int         mnum;
 
-    S_StopSounds();
-
-    // start new music for the level
-    mus_paused = false;
-
     if (gamemode == commercial)
     {
         if (gamemission == pack_nerve)
@@ -345,10 +339,10 @@ void S_Start(void)
                 mus_ddtblu
             };
 
-            mnum = nmus[gamemap - 1];
+            mnum = nmus[map - 1];
         }
         else
-            mnum = mus_runnin + gamemap - 1;
+            mnum = mus_runnin + map - 1;
     }
     else
     {
@@ -366,13 +360,28 @@ void S_Start(void)
             mus_e1m9,           // Tim          e4m9
         };
 
-        if (gameepisode < 4)
-            mnum = mus_e1m1 + (gameepisode-1) * 9 + gamemap - 1;
+        if (episode < 4)
+            mnum = mus_e1m1 + (episode-1) * 9 + map - 1;
         else
-            mnum = spmus[gamemap - 1];
+            mnum = spmus[map - 1];
     }
 
-    S_ChangeMusic(mnum, true, false);
+    return mnum;
+}
+
+//
+// Per level startup code.
+// Kills playing sounds at start of level,
+//  determines music if any, changes music.
+//
+void S_Start(void)
+{
+    S_StopSounds();
+
+    // start new music for the level
+    mus_paused = false;
+
+    S_ChangeMusic(S_GetMusicNum(gameepisode, gamemap), true, false);
 }
 
 void S_StopSound(mobj_t *origin)
@@ -148,6 +148,9 @@ void S_Shutdown(void);
 //
 void S_Start(void);
 
+// Returns the music from sounds.h played on a map.
+int S_GetMusicNum(int episode, int map);
+
 //
 // Start sound for thing at <origin>
 //  using <sound_id> from sounds.h
@@ -240,9 +240,6 @@ static player_t                 *plyr;
 // ST_Start() has just been called
 static boolean                  st_firsttime;
 
-// lump number for PLAYPAL
-static int                      lu_palette;
-
 // used for making messages go away
 static int                      st_msgcounter = 0;
 
@@ -1343,7 +1340,7 @@ void ST_doPaletteStuff(void)
     if (palette != st_palette)
     {
         st_palette = palette;
-        I_SetPalette((byte *)W_CacheLumpNum(lu_palette, PU_CACHE) + palette * 768);
+        I_SetPlayPalette(palette);
     }
 }
 
@@ -1524,7 +1521,6 @@ void ST_loadGraphics(void)
 
 void ST_loadData(void)
 {
-    lu_palette = W_GetNumForName("PLAYPAL");
     ST_loadGraphics();
 }
 
@@ -1744,7 +1740,7 @@ void ST_Stop(void)
     if (st_stopped)
         return;
 
-    I_SetPalette((byte *)W_CacheLumpNum(lu_palette, PU_CACHE));
+    I_SetPlayPalette(0);
 
     st_stopped = true;
 }
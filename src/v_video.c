@@ -43,6 +43,7 @@
 #include "c_console.h"
 #include "d_main.h"
 #include "doomstat.h"
+#include "i_capture.h"
 #include "i_swap.h"
 #include "i_video.h"
 #include "m_config.h"
@@ -876,9 +877,7 @@ void V_DrawFlippedTranslucentRedPatch(int x, int y, patch_t *patch)
     }
 }
 
-#define _FUZZ(a, b)     _fuzzrange[M_RandomInt(a + 1, b + 1)]
-
-const int       _fuzzrange[3] = { -SCREENWIDTH, 0, SCREENWIDTH };
+#define _FUZZ(a, b)     M_RandomInt(a, b)
 
 extern int      fuzztable[SCREENWIDTH * SCREENHEIGHT];
 extern boolean  menuactive;
@@ -909,7 +908,7 @@ void V_DrawFuzzPatch(int x, int y, patch_t *patch)
             {
                 if (!menuactive && !paused && !consoleactive)
                     fuzztable[_fuzzpos] = _FUZZ(-1, 1);
-                *dest = fullcolormap[6 * 256 + dest[fuzztable[_fuzzpos++]]];
+                *dest = fullcolormap[6 * 256 + dest[fuzztable[_fuzzpos++] * SCREENWIDTH]];
                 dest += SCREENWIDTH;
             }
 
@@ -944,7 +943,7 @@ void V_DrawFlippedFuzzPatch(int x, int y, patch_t *patch)
             {
                 if (!menuactive && !paused && !consoleactive)
                     fuzztable[_fuzzpos] = _FUZZ(-1, 1);
-                *dest = fullcolormap[6 * 256 + dest[fuzztable[_fuzzpos++]]];
+                *dest = fullcolormap[6 * 256 + dest[fuzztable[_fuzzpos++] * SCREENWIDTH]];
                 dest += SCREENWIDTH;
             }
 
@@ -1106,7 +1105,7 @@ void V_DrawPixel(int x, int y, byte color, boolean shadow)
     }
 }
 
-void V_LowGraphicDetail(int height)
+void V_LowGraphicDetail(int scrn, int height)
 {
     int x, y;
     int h = pixelheight * SCREENWIDTH;
@@ -1116,7 +1115,7 @@ void V_LowGraphicDetail(int height)
     for (y = 0; y < height; y += h)
         for (x = 0; x < SCREENWIDTH; x += pixelwidth)
         {
-            byte        *dot = screens[0] + y + x;
+            byte        *dot = screens[scrn] + y + x;
             int         xx, yy;
 
             for (yy = 0; yy < h; yy += SCREENWIDTH)
@@ -1158,24 +1157,77 @@ extern int              titlesequence;
 #if defined(SDL20)
 extern SDL_Window       *window;
 extern SDL_Renderer     *renderer;
+
+//
+// V_ReadScreen
+// Reads back what was last presented to the window, at its full resolution.
+//
+static SDL_Surface *V_ReadScreen(void)
+{
+    SDL_Surface *surface = SDL_GetWindowSurface(window);
+    SDL_Surface *screenshot = NULL;
+    byte        *pixels;
+
+    if (!surface)
+        return NULL;
+
+    pixels = malloc(surface->w * surface->h * surface->format->BytesPerPixel);
+    if (!pixels)
+        return NULL;
+
+    if (!SDL_RenderReadPixels(renderer, &surface->clip_rect, surface->format->format, pixels,
+        surface->w * surface->format->BytesPerPixel))
+        screenshot = SDL_CreateRGBSurfaceFrom(pixels, surface->w, surface->h,
+            surface->format->BitsPerPixel, surface->w * surface->format->BytesPerPixel,
+            surface->format->Rmask, surface->format->Gmask, surface->format->Bmask,
+            surface->format->Amask);
+
+    if (!screenshot)
+        free(pixels);
+    return screenshot;
+}
 #else
 extern SDL_Surface      *screen;
 extern SDL_Surface      *screenbuffer;
-extern SDL_Color        palette[256];
+extern SDL_Color        *palette;
+
+//
+// V_ReadScreen
+// Copies the stretched screen at the window's resolution, with its palette.
+//
+static SDL_Surface *V_ReadScreen(void)
+{
+    int         height = MIN(screenbuffer->h, (widescreen ? screen->h : screenbuffer->h));
+    SDL_Surface *screenshot;
+    byte        *pixels = malloc(screenbuffer->pitch * height);
+    int         y;
+
+    if (!pixels)
+        return NULL;
+
+    for (y = 0; y < height; y++)
+        memcpy(pixels + y * screenbuffer->pitch,
+            (byte *)screenbuffer->pixels + y * screenbuffer->pitch, screenbuffer->w);
+
+    if (!(screenshot = SDL_CreateRGBSurfaceFrom(pixels, screenbuffer->w, height, 8,
+        screenbuffer->pitch, 0, 0, 0, 0)))
+    {
+        free(pixels);
+        return NULL;
+    }
+
+    SDL_SetColors(screenshot, palette, 0, 256);
+    return screenshot;
+}
 #endif
 
 boolean V_ScreenShot(void)
 {
-    boolean     result = false;
     char        mapname[128];
     char        folder[MAX_PATH] = "";
     int         count = 0;
     SDL_Surface *screenshot = NULL;
 
-#if defined(SDL20)
-    SDL_Surface *surface;
-#endif
-
 #if defined(WIN32)
     HRESULT     hr = SHGetFolderPath(NULL, CSIDL_MYPICTURES, NULL, SHGFP_TYPE_CURRENT, folder);
 
@@ -1220,44 +1272,9 @@ boolean V_ScreenShot(void)
         M_snprintf(lbmpath, sizeof(lbmpath), "%s" DIR_SEPARATOR_S "%s", lbmpath, lbmname);
     } while (M_FileExists(lbmpath));
 
-#if defined(SDL20)
-    surface = SDL_GetWindowSurface(window);
-    if (surface)
-    {
-        unsigned char   *pixels = malloc(surface->w * surface->h * surface->format->BytesPerPixel);
-
-        if (pixels)
-        {
-            if (!SDL_RenderReadPixels(renderer, &surface->clip_rect, surface->format->format,
-                pixels, surface->w * surface->format->BytesPerPixel))
-            {
-                screenshot = SDL_CreateRGBSurfaceFrom(pixels, surface->w, surface->h,
-                    surface->format->BitsPerPixel, surface->w * surface->format->BytesPerPixel,
-                    surface->format->Rmask, surface->format->Gmask, surface->format->Bmask,
-                    surface->format->Amask);
-
-                if (screenshot)
-                {
-                    result = !SDL_SaveBMP(screenshot, lbmpath);
-                    SDL_FreeSurface(screenshot);
-                    screenshot = NULL;
-                    free(pixels);
-                    SDL_FreeSurface(surface);
-                    surface = NULL;
-                }
-            }
-        }
-    }
-#else
-    screenshot = SDL_CreateRGBSurface(screenbuffer->flags, screenbuffer->w,
-        (widescreen ? screen->h : screenbuffer->h), screenbuffer->format->BitsPerPixel,
-        screenbuffer->format->Rmask, screenbuffer->format->Gmask, screenbuffer->format->Bmask,
-        screenbuffer->format->Amask);
+    // the capture thread saves the copy, so only making it waits here
+    if (!headless && !(screenshot = V_ReadScreen()))
+        return false;
 
-    SDL_SetColors(screenshot, palette, 0, 256);
-    SDL_BlitSurface(screenbuffer, NULL, screenshot, NULL);
-    result = !SDL_SaveBMP(screenshot, lbmpath);
-    SDL_FreeSurface(screenshot);
-#endif
-    return result;
+    return I_QueueScreenShot(lbmpath, screenshot);
 }
@@ -97,7 +97,7 @@ void V_DrawPatchToTempScreen(int x, int y, patch_t *patch);
 
 void V_DrawPixel(int x, int y, byte color, boolean shadow);
 
-void V_LowGraphicDetail(int height);
+void V_LowGraphicDetail(int scrn, int height);
 
 // Draw a linear block of pixels into the view buffer.
 void V_DrawBlock(int x, int y, int width, int height, byte *src);
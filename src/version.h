@@ -51,6 +51,7 @@
 #define PACKAGE_COPYRIGHT               " 2013-2015 Brad Harding. All rights reserved."
 #define PACKAGE_EMAIL                   "brad@doomretro.com"
 #define PACKAGE_ICON_PATH               "..\\res\\doomretro.ico"
+#define PACKAGE_INDEX                   "doomretro.idx"
 #define PACKAGE_MUTEX                   "DOOMRETRO-CC4F1071-8B24-4E91-A207-D792F39636CD"
 #define PACKAGE_NAME_A                  "DOOM RETRO"
 #define PACKAGE_NAME_W                  L"DOOM RETRO"
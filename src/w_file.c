@@ -98,3 +98,9 @@ size_t W_Read(wad_file_t *wad, unsigned int offset, void *buffer, size_t buffer_
 {
     return wad->file_class->Read(wad, offset, buffer, buffer_len);
 }
+
+void W_Prefetch(wad_file_t *wad, unsigned int offset, size_t length)
+{
+    if (wad->file_class->Prefetch && length)
+        wad->file_class->Prefetch(wad, offset, length);
+}
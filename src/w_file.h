@@ -53,8 +53,13 @@ typedef struct
     void (*CloseFile)(wad_file_t *file);
 
     // Read data from the specified position in the file into the
-    // provided buffer.  Returns the number of bytes read.
+    // provided buffer.  Returns the number of bytes read. Safe to call
+    // from several threads at once.
     size_t (*Read)(wad_file_t *file, unsigned int offset, void *buffer, size_t buffer_len);
+
+    // Hint that data at the specified position in the file will be read
+    // soon, so the OS can start reading it in the background. May be NULL.
+    void (*Prefetch)(wad_file_t *file, unsigned int offset, size_t length);
 } wad_file_class_t;
 
 struct _wad_file_s
@@ -88,4 +93,7 @@ void W_CloseFile(wad_file_t *wad);
 // Returns the number of bytes read.
 size_t W_Read(wad_file_t *wad, unsigned int offset, void *buffer, size_t buffer_len);
 
+// Hint that data from the specified WAD file will be read soon.
+void W_Prefetch(wad_file_t *wad, unsigned int offset, size_t length);
+
 #endif
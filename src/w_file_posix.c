@@ -77,7 +77,7 @@ static void MapFile(posix_wad_file_t *wad)
                   protection, flags, 
                   wad->handle, 0);
 
-    wad->wad.mapped = result;
+    wad->wad.mapped = (result == MAP_FAILED ? NULL : result);
 }
 
 unsigned int GetFileLength(int handle)
@@ -116,6 +116,8 @@ static void W_POSIX_CloseFile(wad_file_t *wad)
     posix_wad = (posix_wad_file_t *) wad;
 
     // If mapped, unmap it.
+    if (posix_wad->wad.mapped != NULL)
+        munmap(posix_wad->wad.mapped, posix_wad->wad.length);
 
     // Close the file
     close(posix_wad->handle);
@@ -123,7 +125,8 @@ static void W_POSIX_CloseFile(wad_file_t *wad)
 }
 
 // Read data from the specified position in the file into the 
-// provided buffer.  Returns the number of bytes read.
+// provided buffer.  Returns the number of bytes read. Uses pread, which
+// doesn't move the file offset, so it's safe from several threads at once.
 size_t W_POSIX_Read(wad_file_t *wad, unsigned int offset, void *buffer, size_t buffer_len)
 {
     posix_wad_file_t    *posix_wad;
@@ -132,16 +135,14 @@ size_t W_POSIX_Read(wad_file_t *wad, unsigned int offset, void *buffer, size_t b
 
     posix_wad = (posix_wad_file_t *) wad;
 
-    // Jump to the specified position in the file.
-    lseek(posix_wad->handle, offset, SEEK_SET);
-
     // Read into the buffer.
     bytes_read = 0;
     byte_buffer = buffer;
 
     while (buffer_len > 0)
     {
-        int     result = read(posix_wad->handle, byte_buffer, buffer_len);
+        ssize_t result = pread(posix_wad->handle, byte_buffer, buffer_len,
+                               (off_t)offset + bytes_read);
 
         if (result < 0)
         {
@@ -160,12 +161,41 @@ size_t W_POSIX_Read(wad_file_t *wad, unsigned int offset, void *buffer, size_t b
     return bytes_read;
 }
 
+// Ask the kernel to start reading part of the file in the background,
+// with madvise if it's mapped, or through the page cache if not.
+static void W_POSIX_Prefetch(wad_file_t *wad, unsigned int offset, size_t length)
+{
+    posix_wad_file_t    *posix_wad;
+
+    posix_wad = (posix_wad_file_t *) wad;
+
+    if (wad->mapped != NULL)
+    {
+        // madvise needs a page-aligned start
+        size_t  start = offset & ~((size_t)sysconf(_SC_PAGESIZE) - 1);
+
+        madvise(wad->mapped + start, length + offset - start, MADV_WILLNEED);
+    }
+    else
+    {
+#if defined(POSIX_FADV_WILLNEED)
+        posix_fadvise(posix_wad->handle, offset, length, POSIX_FADV_WILLNEED);
+#elif defined(F_RDADVISE)
+        struct radvisory        advisory;
+
+        advisory.ra_offset = offset;
+        advisory.ra_count = (int)length;
+        fcntl(posix_wad->handle, F_RDADVISE, &advisory);
+#endif
+    }
+}
 
 wad_file_class_t posix_wad_file = 
 {
     W_POSIX_OpenFile,
     W_POSIX_CloseFile,
     W_POSIX_Read,
+    W_POSIX_Prefetch,
 };
 
 #endif
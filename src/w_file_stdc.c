@@ -38,6 +38,11 @@
 
 #include <stdio.h>
 
+#if !defined(WIN32)
+#include <fcntl.h>
+#endif
+
+#include "i_thread.h"
 #include "m_misc.h"
 #include "w_file.h"
 #include "z_zone.h"
@@ -46,6 +51,9 @@ typedef struct
 {
     wad_file_t  wad;
     FILE        *fstream;
+
+    // Serializes the seek and read in W_StdC_Read between threads
+    SDL_mutex   *lock;
 } stdc_wad_file_t;
 
 extern wad_file_class_t stdc_wad_file;
@@ -66,6 +74,7 @@ static wad_file_t *W_StdC_OpenFile(char *path)
     result->wad.mapped = NULL;
     result->wad.length = M_FileLength(fstream);
     result->fstream = fstream;
+    result->lock = I_CreateMutex();
 
     return &result->wad;
 }
@@ -77,6 +86,7 @@ static void W_StdC_CloseFile(wad_file_t *wad)
     stdc_wad = (stdc_wad_file_t *) wad;
 
     fclose(stdc_wad->fstream);
+    I_DestroyMutex(stdc_wad->lock);
     Z_Free(stdc_wad);
 }
 
@@ -91,18 +101,41 @@ size_t W_StdC_Read(wad_file_t *wad, unsigned int offset,
 
     stdc_wad = (stdc_wad_file_t *)wad;
 
+    I_LockMutex(stdc_wad->lock);
+
     // Jump to the specified position in the file.
     fseek(stdc_wad->fstream, offset, SEEK_SET);
 
     // Read into the buffer.
     result = fread(buffer, 1, buffer_len, stdc_wad->fstream);
 
+    I_UnlockMutex(stdc_wad->lock);
+
     return result;
 }
 
+// Ask the OS to start reading part of the file in the background, where
+// there's a way to do that with the underlying file descriptor.
+static void W_StdC_Prefetch(wad_file_t *wad, unsigned int offset, size_t length)
+{
+#if defined(POSIX_FADV_WILLNEED)
+    stdc_wad_file_t     *stdc_wad = (stdc_wad_file_t *)wad;
+
+    posix_fadvise(fileno(stdc_wad->fstream), offset, length, POSIX_FADV_WILLNEED);
+#elif defined(F_RDADVISE)
+    stdc_wad_file_t     *stdc_wad = (stdc_wad_file_t *)wad;
+    struct radvisory    advisory;
+
+    advisory.ra_offset = offset;
+    advisory.ra_count = (int)length;
+    fcntl(fileno(stdc_wad->fstream), F_RDADVISE, &advisory);
+#endif
+}
+
 wad_file_class_t stdc_wad_file = 
 {
     W_StdC_OpenFile,
     W_StdC_CloseFile,
     W_StdC_Read,
+    W_StdC_Prefetch,
 };
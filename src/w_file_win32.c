@@ -39,6 +39,7 @@
 #if defined(WIN32)
 
 #include <stdio.h>
+#include <string.h>
 
 #define WIN32_LEAN_AND_MEAN
 
@@ -128,31 +129,67 @@ static void W_Win32_CloseFile(wad_file_t *wad)
 }
 
 // Read data from the specified position in the file into the 
-// provided buffer.  Returns the number of bytes read.
+// provided buffer.  Returns the number of bytes read. The position is
+// given to ReadFile rather than set with SetFilePointer first, so it's
+// safe from several threads at once.
 size_t W_Win32_Read(wad_file_t *wad, unsigned int offset, void *buffer, size_t buffer_len)
 {
     win32_wad_file_t    *win32_wad = (win32_wad_file_t *)wad;
     DWORD               bytes_read;
-    DWORD               result;
+    OVERLAPPED          overlapped;
 
-    // Jump to the specified position in the file.
-    result = SetFilePointer(win32_wad->handle, offset, NULL, FILE_BEGIN);
-
-    if (result == INVALID_SET_FILE_POINTER)
-        I_Error("W_Win32_Read: Failed to set file pointer to %i", offset);
+    memset(&overlapped, 0, sizeof(overlapped));
+    overlapped.Offset = offset;
 
     // Read into the buffer.
-    if (!ReadFile(win32_wad->handle, buffer, buffer_len, &bytes_read, NULL))
+    if (!ReadFile(win32_wad->handle, buffer, buffer_len, &bytes_read, &overlapped)
+        && GetLastError() != ERROR_HANDLE_EOF)
         I_Error("W_Win32_Read: Error reading from file");
 
     return bytes_read;
 }
 
+// PrefetchVirtualMemory, which is only in Windows 8 and later
+typedef struct
+{
+    PVOID       VirtualAddress;
+    SIZE_T      NumberOfBytes;
+} prefetchrange_t;
+
+typedef BOOL (WINAPI *prefetchvirtualmemory_t)(HANDLE, ULONG_PTR, prefetchrange_t *, ULONG);
+
+// Ask Windows to start reading part of the file in the background, if it's
+// mapped. Reads of files that aren't are left to the cache manager.
+static void W_Win32_Prefetch(wad_file_t *wad, unsigned int offset, size_t length)
+{
+    static prefetchvirtualmemory_t      prefetchvirtualmemory;
+    static boolean                      checked;
+    prefetchrange_t                     range;
+
+    if (!wad->mapped)
+        return;
+
+    if (!checked)
+    {
+        prefetchvirtualmemory = (prefetchvirtualmemory_t)GetProcAddress(
+            GetModuleHandle("kernel32.dll"), "PrefetchVirtualMemory");
+        checked = true;
+    }
+
+    if (!prefetchvirtualmemory)
+        return;
+
+    range.VirtualAddress = wad->mapped + offset;
+    range.NumberOfBytes = length;
+    prefetchvirtualmemory(GetCurrentProcess(), 1, &range, 0);
+}
+
 wad_file_class_t win32_wad_file = 
 {
     W_Win32_OpenFile,
     W_Win32_CloseFile,
-    W_Win32_Read
+    W_Win32_Read,
+    W_Win32_Prefetch
 };
 
 #endif
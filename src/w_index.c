@@ -0,0 +1,343 @@
+/*
+========================================================================
+
+                               DOOM RETRO
+         The classic, refined DOOM source port. For Windows PC.
+
+========================================================================
+
+  Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+  Copyright (C) 2013-2015 Brad Harding.
+
+  DOOM RETRO is a fork of CHOCOLATE DOOM by Simon Howard.
+  For a complete list of credits, see the accompanying AUTHORS file.
+
+  This file is part of DOOM RETRO.
+
+  DOOM RETRO is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  DOOM RETRO is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with DOOM RETRO. If not, see <http://www.gnu.org/licenses/>.
+
+  DOOM is a registered trademark of id Software LLC, a ZeniMax Media
+  company, in the US and/or other countries and is used without
+  permission. All other trademarks are the property of their respective
+  holders. DOOM RETRO is in no way affiliated with nor endorsed by
+  id Software LLC.
+
+========================================================================
+*/
+
+#include <sys/stat.h>
+
+#include "c_console.h"
+#include "doomdef.h"
+#include "m_fixed.h"
+#include "m_misc.h"
+#include "version.h"
+#include "w_file.h"
+#include "w_index.h"
+#include "w_wad.h"
+#include "z_zone.h"
+
+#if !defined(MAX_PATH)
+#define MAX_PATH        260
+#endif
+
+#define INDEXID         "DRIX"
+#define INDEXVERSION    1
+
+//
+// The index is cached in PACKAGE_INDEX between launches. It starts with an
+//  indexheader_t, and an indexwad_t for each WAD that lumps were loaded from,
+//  which are compared with those of the WADs loaded now. Then each section
+//  follows its indexsectionheader_t, padded to 8 bytes.
+//
+typedef struct
+{
+    char                id[4];
+    int                 version;
+    int                 numwads;
+    unsigned int        numlumps;
+    uint64_t            directoryhash;
+} indexheader_t;
+
+typedef struct
+{
+    char                path[MAX_PATH];
+    unsigned int        length;
+    int64_t             mtime;
+} indexwad_t;
+
+typedef struct
+{
+    int                 section;
+    int                 size;
+} indexsectionheader_t;
+
+static indexheader_t    header;
+static indexwad_t       *wads;
+static wad_file_t       **wadfiles;
+
+// index loaded from disk, either mapped or read into indexdata
+static wad_file_t       *indexfile;
+static byte             *indexdata;
+
+static struct
+{
+    byte                *data;
+    int                 size;
+    boolean             isnew;
+} sections[NUMINDEXSECTIONS];
+
+//
+// W_HashIndexBytes
+// FNV-1a, 64 bits.
+//
+static uint64_t W_HashIndexBytes(uint64_t hash, const void *data, size_t size)
+{
+    const byte  *p = data;
+
+    while (size--)
+        hash = (hash ^ *p++) * 0x100000001b3ull;
+
+    return hash;
+}
+
+//
+// W_BuildIndexHeader
+// Fills in the header and WADs that the index must match, from the lumps
+//  loaded now.
+//
+static void W_BuildIndexHeader(void)
+{
+    wad_file_t          *last = NULL;
+    int                 wad = -1;
+    unsigned int        i;
+
+    memcpy(header.id, INDEXID, sizeof(header.id));
+    header.version = INDEXVERSION;
+    header.numwads = 0;
+    header.numlumps = numlumps;
+    header.directoryhash = 0xcbf29ce484222325ull;
+
+    for (i = 0; i < numlumps; ++i)
+    {
+        lumpinfo_t      *lump = &lumpinfo[i];
+
+        if (lump->wad_file != last)
+        {
+            last = lump->wad_file;
+
+            for (wad = 0; wad < header.numwads; ++wad)
+                if (wadfiles[wad] == last)
+                    break;
+
+            if (wad == header.numwads)
+            {
+                struct stat     status;
+
+                wads = realloc(wads, (header.numwads + 1) * sizeof(*wads));
+                wadfiles = realloc(wadfiles, (header.numwads + 1) * sizeof(*wadfiles));
+                memset(&wads[wad], 0, sizeof(*wads));
+                M_StringCopy(wads[wad].path, last->path, sizeof(wads[wad].path));
+                wads[wad].length = last->length;
+                if (!stat(last->path, &status))
+                    wads[wad].mtime = status.st_mtime;
+                wadfiles[wad] = last;
+                ++header.numwads;
+            }
+        }
+
+        header.directoryhash = W_HashIndexBytes(header.directoryhash, lump->name,
+            sizeof(lump->name));
+        header.directoryhash = W_HashIndexBytes(header.directoryhash, &lump->position,
+            sizeof(lump->position));
+        header.directoryhash = W_HashIndexBytes(header.directoryhash, &lump->size,
+            sizeof(lump->size));
+        header.directoryhash = W_HashIndexBytes(header.directoryhash, &wad, sizeof(wad));
+    }
+}
+
+//
+// W_CloseIndexFile
+//
+static void W_CloseIndexFile(void)
+{
+    int i;
+
+    for (i = 0; i < NUMINDEXSECTIONS; ++i)
+        if (!sections[i].isnew)
+        {
+            sections[i].data = NULL;
+            sections[i].size = 0;
+        }
+
+    if (indexfile)
+    {
+        if (!indexfile->mapped)
+            Z_Free(indexdata);
+        W_CloseFile(indexfile);
+        indexfile = NULL;
+    }
+    indexdata = NULL;
+}
+
+//
+// W_LoadIndex
+//
+void W_LoadIndex(void)
+{
+    size_t      length;
+    size_t      pos;
+    size_t      wadslength;
+
+    W_BuildIndexHeader();
+
+    if (!(indexfile = W_OpenFile(PACKAGE_INDEX)))
+        return;
+
+    length = indexfile->length;
+    if (indexfile->mapped)
+        indexdata = indexfile->mapped;
+    else
+    {
+        indexdata = Z_Malloc(length, PU_STATIC, NULL);
+        if (W_Read(indexfile, 0, indexdata, length) != length)
+        {
+            W_CloseIndexFile();
+            return;
+        }
+    }
+
+    // the index is only valid if it was made from the same WADs and directory
+    wadslength = header.numwads * sizeof(*wads);
+    if (length < sizeof(header) + wadslength
+        || memcmp(indexdata, &header, sizeof(header))
+        || memcmp(indexdata + sizeof(header), wads, wadslength))
+    {
+        W_CloseIndexFile();
+        return;
+    }
+
+    pos = sizeof(header) + wadslength;
+    while (pos + sizeof(indexsectionheader_t) <= length)
+    {
+        indexsectionheader_t    sectionheader;
+
+        memcpy(&sectionheader, indexdata + pos, sizeof(sectionheader));
+        pos += sizeof(sectionheader);
+
+        if (sectionheader.section < 0 || sectionheader.section >= NUMINDEXSECTIONS
+            || sectionheader.size < 0 || pos + sectionheader.size > length)
+            break;
+
+        sections[sectionheader.section].data = indexdata + pos;
+        sections[sectionheader.section].size = sectionheader.size;
+        pos += (sectionheader.size + 7) & ~7;
+    }
+
+    C_Output("Loaded the lump index from %s.", uppercase(PACKAGE_INDEX));
+}
+
+//
+// W_GetIndexSection
+//
+void *W_GetIndexSection(indexsection_t section, int size)
+{
+    return (sections[section].data && sections[section].size == size ? sections[section].data :
+        NULL);
+}
+
+//
+// W_NewIndexSection
+//
+void *W_NewIndexSection(indexsection_t section, int size)
+{
+    if (sections[section].isnew)
+        free(sections[section].data);
+
+    sections[section].data = calloc(1, MAX(size, 1));
+    sections[section].size = size;
+    sections[section].isnew = true;
+
+    return sections[section].data;
+}
+
+//
+// W_SaveIndex
+//
+void W_SaveIndex(void)
+{
+    boolean     save = false;
+    int         i;
+
+    for (i = 0; i < NUMINDEXSECTIONS; ++i)
+        if (sections[i].isnew)
+            save = true;
+
+    if (save)
+    {
+        FILE    *file;
+
+        // keep the sections that are still good before closing the file
+        //  they're in, so it can be written over
+        for (i = 0; i < NUMINDEXSECTIONS; ++i)
+            if (sections[i].data && !sections[i].isnew)
+            {
+                byte    *data = malloc(MAX(sections[i].size, 1));
+
+                memcpy(data, sections[i].data, sections[i].size);
+                sections[i].data = data;
+                sections[i].isnew = true;
+            }
+        W_CloseIndexFile();
+
+        if ((file = fopen(PACKAGE_INDEX, "wb")))
+        {
+            static const byte   padding[8];
+
+            fwrite(&header, sizeof(header), 1, file);
+            fwrite(wads, sizeof(*wads), header.numwads, file);
+
+            for (i = 0; i < NUMINDEXSECTIONS; ++i)
+                if (sections[i].data)
+                {
+                    indexsectionheader_t        sectionheader;
+
+                    sectionheader.section = i;
+                    sectionheader.size = sections[i].size;
+                    fwrite(&sectionheader, sizeof(sectionheader), 1, file);
+                    fwrite(sections[i].data, 1, sections[i].size, file);
+                    fwrite(padding, 1, -sections[i].size & 7, file);
+                }
+
+            if (!fclose(file))
+                C_Output("Saved the lump index to %s.", uppercase(PACKAGE_INDEX));
+        }
+    }
+
+    W_CloseIndexFile();
+
+    for (i = 0; i < NUMINDEXSECTIONS; ++i)
+    {
+        if (sections[i].isnew)
+            free(sections[i].data);
+        sections[i].data = NULL;
+        sections[i].size = 0;
+        sections[i].isnew = false;
+    }
+
+    free(wads);
+    free(wadfiles);
+    wads = NULL;
+    wadfiles = NULL;
+}
@@ -0,0 +1,67 @@
+/*
+========================================================================
+
+                               DOOM RETRO
+         The classic, refined DOOM source port. For Windows PC.
+
+========================================================================
+
+  Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+  Copyright (C) 2013-2015 Brad Harding.
+
+  DOOM RETRO is a fork of CHOCOLATE DOOM by Simon Howard.
+  For a complete list of credits, see the accompanying AUTHORS file.
+
+  This file is part of DOOM RETRO.
+
+  DOOM RETRO is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  DOOM RETRO is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with DOOM RETRO. If not, see <http://www.gnu.org/licenses/>.
+
+  DOOM is a registered trademark of id Software LLC, a ZeniMax Media
+  company, in the US and/or other countries and is used without
+  permission. All other trademarks are the property of their respective
+  holders. DOOM RETRO is in no way affiliated with nor endorsed by
+  id Software LLC.
+
+========================================================================
+*/
+
+#if !defined(__W_INDEX__)
+#define __W_INDEX__
+
+#include "doomtype.h"
+
+// Sections of tables derived from the lumps that are kept in the index
+typedef enum
+{
+    INDEX_TEXTURES,
+    INDEX_SPRITES,
+    NUMINDEXSECTIONS
+} indexsection_t;
+
+// Opens the index cached from the last launch, if it was made from the same
+// WADs, with the same lump directory, as are loaded now.
+void W_LoadIndex(void);
+
+// Returns a section of the index, or NULL if it isn't there or isn't the
+// expected size.
+void *W_GetIndexSection(indexsection_t section, int size);
+
+// Returns a new section for the index to be filled in, and written by
+// W_SaveIndex.
+void *W_NewIndexSection(indexsection_t section, int size);
+
+// Writes the index if any sections were put in it, and closes it.
+void W_SaveIndex(void);
+
+#endif
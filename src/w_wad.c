@@ -43,6 +43,8 @@
 #include "doomstat.h"
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_thread.h"
+#include "i_timer.h"
 #include "m_misc.h"
 #include "w_wad.h"
 #include "z_zone.h"
@@ -79,8 +81,39 @@ typedef struct
 lumpinfo_t      *lumpinfo;
 unsigned int    numlumps = 0;
 
-// Hash table for fast lookups
-static lumpinfo_t **lumphash;
+// Open-addressing hash table for fast lookups, keyed on lump names packed
+//  into 64-bit integers by W_LumpNameKey. Each entry has the last lump with
+//  its name, and a run of lumpoccurrences with all of them, in order.
+typedef struct
+{
+    uint64_t    key;
+    int         lump;
+    int         first;
+    int         count;
+} lumphash_t;
+
+static lumphash_t       *lumphash;
+static unsigned int     lumphashmask;
+static int              lumphashshift;
+static int              *lumpoccurrences;
+
+// Lumps between the markers of each namespace, found when the hash table is
+//  generated
+static struct
+{
+    char        *start;
+    char        *end;
+    boolean     found;
+    int         first;
+    int         last;
+} namespaces[NUMLUMPNAMESPACES] =
+{
+    { "F_START", "F_END" },
+    { "S_START", "S_END" }
+};
+
+// Serializes the lump cache (and so the zone) between render threads
+static SDL_mutex *cachemutex;
 
 void ExtractFileBase(char *path, char *dest)
 {
@@ -117,6 +150,31 @@ unsigned int W_LumpNameHash(const char *s)
     return result;
 }
 
+// Packs an uppercase copy of a lump name into a 64-bit integer, so that
+// names can be compared with a single integer compare.
+uint64_t W_LumpNameKey(const char *name)
+{
+    uint64_t            key = 0;
+    unsigned int        i;
+
+    for (i = 0; i < 8 && name[i] != '\0'; ++i)
+    {
+        int     c = (unsigned char)name[i];
+
+        if (c >= 'a' && c <= 'z')
+            c -= 'a' - 'A';
+        key |= (uint64_t)c << (i * 8);
+    }
+
+    return key;
+}
+
+// Slot in lumphash to start looking for a key in.
+static unsigned int W_LumpHashSlot(uint64_t key)
+{
+    return (unsigned int)((key * 0x9e3779b97f4a7c15ull) >> lumphashshift);
+}
+
 // Increase the size of the lumpinfo[] array to the specified size.
 static void ExtendLumpInfo(int newnumlumps)
 {
@@ -137,11 +195,6 @@ static void ExtendLumpInfo(int newnumlumps)
 
         if (newlumpinfo[i].cache != NULL)
             Z_ChangeUser(newlumpinfo[i].cache, &newlumpinfo[i].cache);
-
-        // We shouldn't be generating a hash table until after all WADs have
-        // been loaded, but just in case...
-        if (lumpinfo[i].next != NULL)
-            newlumpinfo[i].next = &newlumpinfo[lumpinfo[i].next - lumpinfo];
     }
 
     // All done.
@@ -249,6 +302,7 @@ wad_file_t *W_AddFile(char *filename, boolean automatic)
     if (lumphash != NULL)
     {
         Z_Free(lumphash);
+        Z_Free(lumpoccurrences);
         lumphash = NULL;
     }
 
@@ -389,25 +443,68 @@ int W_NumLumps(void)
     return numlumps;
 }
 
+//
+// W_FindLumpHash
+// Returns the hash table entry for a lump name, or NULL if there's no lump
+// with that name.
+//
+static lumphash_t *W_FindLumpHash(const char *name)
+{
+    uint64_t            key = W_LumpNameKey(name);
+    unsigned int        slot;
+
+    for (slot = W_LumpHashSlot(key); lumphash[slot].lump >= 0; slot = (slot + 1) & lumphashmask)
+        if (lumphash[slot].key == key)
+            return &lumphash[slot];
+
+    return NULL;
+}
+
+//
+// W_FindLumpInRange
+// Binary searches the occurrences of a lump name for the first one between
+// min and max. Returns -1 if there isn't one.
+//
+static int W_FindLumpInRange(const char *name, int min, int max)
+{
+    lumphash_t  *entry = W_FindLumpHash(name);
+    int         *occurrences;
+    int         low = 0;
+    int         high;
+
+    if (entry == NULL)
+        return -1;
+
+    occurrences = lumpoccurrences + entry->first;
+    high = entry->count;
+
+    while (low < high)
+    {
+        int     mid = (low + high) / 2;
+
+        if (occurrences[mid] < min)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return (low < entry->count && occurrences[low] <= max ? occurrences[low] : -1);
+}
+
 //
 // W_CheckNumForName
 // Returns -1 if name not found.
 //
 int W_CheckNumForName(char *name)
 {
-    lumpinfo_t  *lump_p;
-
     // Do we have a hash table yet?
     if (lumphash != NULL)
     {
-        int     hash;
-
         // We do! Excellent.
-        hash = W_LumpNameHash(name) % numlumps;
+        lumphash_t      *entry = W_FindLumpHash(name);
 
-        for (lump_p = lumphash[hash]; lump_p != NULL; lump_p = lump_p->next)
-            if (!strncasecmp(lump_p->name, name, 8))
-                return lump_p - lumpinfo;
+        if (entry != NULL)
+            return entry->lump;
     }
     else
     {
@@ -436,6 +533,13 @@ int W_CheckMultipleLumps(char *name)
     if (FREEDOOM || hacx)
         return 3;
 
+    if (lumphash != NULL)
+    {
+        lumphash_t      *entry = W_FindLumpHash(name);
+
+        return (entry != NULL ? entry->count : 0);
+    }
+
     for (i = numlumps - 1; i >= 0; --i)
         if (!strncasecmp(lumpinfo[i].name, name, 8))
             ++count;
@@ -445,22 +549,63 @@ int W_CheckMultipleLumps(char *name)
 
 //
 // W_RangeCheckNumForName
-// Linear Search that checks for a lump number ONLY
+// Search that checks for a lump number ONLY
 // inside a range, not all lumps.
 //
 int W_RangeCheckNumForName(int min, int max, char *name)
 {
     int         i;
 
-    for (i = min; i <= max; i++)
-        if (!strncasecmp(lumpinfo[i].name, name, 8))
+    if (lumphash != NULL)
+    {
+        if ((i = W_FindLumpInRange(name, min, max)) >= 0)
             return i;
+    }
+    else
+        for (i = min; i <= max; i++)
+            if (!strncasecmp(lumpinfo[i].name, name, 8))
+                return i;
 
     I_Error("W_RangeCheckNumForName: %s not found!", name);
 
     return 0;
 }
 
+//
+// W_GetNamespace
+// Gets the first and last lumps between the markers of a namespace. Returns
+// false if the markers weren't found.
+//
+boolean W_GetNamespace(lumpnamespace_t ns, int *first, int *last)
+{
+    *first = namespaces[ns].first;
+    *last = namespaces[ns].last;
+
+    return namespaces[ns].found;
+}
+
+//
+// W_CheckNumForNameInNamespace
+// Returns the first lump with a name between the markers of a namespace, or
+// -1 if there isn't one.
+//
+int W_CheckNumForNameInNamespace(char *name, lumpnamespace_t ns)
+{
+    int         i;
+
+    if (!namespaces[ns].found)
+        return -1;
+
+    if (lumphash != NULL)
+        return W_FindLumpInRange(name, namespaces[ns].first, namespaces[ns].last);
+
+    for (i = namespaces[ns].first; i <= namespaces[ns].last; i++)
+        if (!strncasecmp(lumpinfo[i].name, name, 8))
+            return i;
+
+    return -1;
+}
+
 //
 // W_GetNumForName
 // Calls W_CheckNumForName, but bombs out if not found.
@@ -482,6 +627,16 @@ int W_GetNumForName2(char *name)
 {
     unsigned int i;
 
+    if (lumphash != NULL)
+    {
+        lumphash_t      *entry = W_FindLumpHash(name);
+
+        if (entry == NULL)
+            I_Error("W_GetNumForName: %s not found!", name);
+
+        return lumpoccurrences[entry->first];
+    }
+
     for (i = 0; i < numlumps; i++)
         if (!strncasecmp(lumpinfo[i].name, name, 8))
             break;
@@ -496,6 +651,16 @@ int W_GetNumForNameX(char *name, unsigned int count)
 {
     unsigned int i, j = 0;
 
+    if (lumphash != NULL)
+    {
+        lumphash_t      *entry = W_FindLumpHash(name);
+
+        if (entry == NULL || count < 1 || count > (unsigned int)entry->count)
+            I_Error("W_GetNumForNameX: %s not found!", name);
+
+        return lumpoccurrences[entry->first + count - 1];
+    }
+
     for (i = 0; i < numlumps; i++)
         if (!strncasecmp(lumpinfo[i].name, name, 8))
             if (++j == count)
@@ -540,6 +705,51 @@ void W_ReadLump(unsigned int lump, void *dest)
         I_Error("W_ReadLump: only read %i of %i on lump %i", c, l->size, lump);
 }
 
+//
+// W_PrefetchLumps
+//
+// Hint that count lumps starting at lump will soon be cached, so the
+// OS can start reading them from disk now. Lumps already in the cache
+// are skipped, and lumps next to each other in the same file are hinted
+// as one range.
+//
+void W_PrefetchLumps(int lump, int count)
+{
+    wad_file_t  *wad_file = NULL;
+    int         start = 0;
+    int         end = 0;
+    int         i;
+
+    if (lump < 0)
+        return;
+
+    count = MIN(count, (int)numlumps - lump);
+
+    for (i = lump; i < lump + count; i++)
+    {
+        lumpinfo_t      *l = lumpinfo + i;
+
+        if (l->cache || l->size <= 0)
+            continue;
+
+        if (l->wad_file == wad_file && l->position >= start && l->position <= end)
+        {
+            end = MAX(end, l->position + l->size);
+            continue;
+        }
+
+        if (wad_file)
+            W_Prefetch(wad_file, start, end - start);
+
+        wad_file = l->wad_file;
+        start = l->position;
+        end = l->position + l->size;
+    }
+
+    if (wad_file)
+        W_Prefetch(wad_file, start, end - start);
+}
+
 //
 // W_CacheLumpNum
 //
@@ -569,9 +779,12 @@ void *W_CacheLumpNum(int lumpnum, int tag)
     if (lump->wad_file->mapped != NULL)
     {
         // Memory mapped file, return from the mmapped region.
-        result = lump->wad_file->mapped + lump->position;
+        return (lump->wad_file->mapped + lump->position);
     }
-    else if (lump->cache != NULL)
+
+    W_LockCache();
+
+    if (lump->cache != NULL)
     {
         // Already cached, so just switch the zone tag.
         result = (byte *)lump->cache;
@@ -585,9 +798,31 @@ void *W_CacheLumpNum(int lumpnum, int tag)
         result = (byte *)lump->cache;
     }
 
+    W_UnlockCache();
+
     return result;
 }
 
+//
+// W_LockCache
+//
+// Lock the lump cache while it is changed, as lumps may be cached by
+// several render threads at once. The mutex is created by the first
+// lump cached at startup, before any render threads are running.
+//
+void W_LockCache(void)
+{
+    if (!cachemutex)
+        cachemutex = I_CreateMutex();
+
+    I_LockMutex(cachemutex);
+}
+
+void W_UnlockCache(void)
+{
+    I_UnlockMutex(cachemutex);
+}
+
 //
 // W_CacheLumpName
 //
@@ -615,7 +850,11 @@ void W_ReleaseLumpNum(int lumpnum)
     lump = &lumpinfo[lumpnum];
 
     if (!lump->wad_file->mapped)
+    {
+        W_LockCache();
         Z_ChangeTag(lump->cache, PU_CACHE);
+        W_UnlockCache();
+    }
 }
 
 void W_ReleaseLumpName(char *name)
@@ -626,30 +865,127 @@ void W_ReleaseLumpName(char *name)
 // Generate a hash table for fast lookups
 void W_GenerateHashTable(void)
 {
+    unsigned int        i;
+
     // Free the old hash table, if there is one
     if (lumphash != NULL)
+    {
         Z_Free(lumphash);
+        Z_Free(lumpoccurrences);
+    }
+
+    lumphash = NULL;
 
-    // Generate hash table
+    // Generate hash table, with at least twice as many slots as lumps so
+    // probe sequences stay short
     if (numlumps > 0)
     {
-        unsigned int    i;
+        unsigned int    size = 2;
+        int             first = 0;
 
-        lumphash = Z_Malloc(sizeof(lumpinfo_t *) * numlumps, PU_STATIC, NULL);
-        memset(lumphash, 0, sizeof(lumpinfo_t *) * numlumps);
+        lumphashshift = 63;
+        while (size < numlumps * 2)
+        {
+            size <<= 1;
+            --lumphashshift;
+        }
+        lumphashmask = size - 1;
 
+        lumphash = Z_Malloc(sizeof(lumphash_t) * size, PU_STATIC, NULL);
+        lumpoccurrences = Z_Malloc(sizeof(int) * numlumps, PU_STATIC, NULL);
+        for (i = 0; i < size; ++i)
+        {
+            lumphash[i].lump = -1;
+            lumphash[i].count = 0;
+        }
+
+        // Later lumps replace earlier ones with the same name, so patch lump
+        // files take precedence
         for (i = 0; i < numlumps; ++i)
         {
-            unsigned int        hash;
+            uint64_t            key = W_LumpNameKey(lumpinfo[i].name);
+            unsigned int        slot = W_LumpHashSlot(key);
 
-            hash = W_LumpNameHash(lumpinfo[i].name) % numlumps;
+            while (lumphash[slot].lump >= 0 && lumphash[slot].key != key)
+                slot = (slot + 1) & lumphashmask;
 
-            // Hook into the hash table
+            lumphash[slot].key = key;
+            lumphash[slot].lump = i;
+            ++lumphash[slot].count;
+        }
+
+        // Give each name a run of lumpoccurrences, and fill them in order
+        for (i = 0; i < size; ++i)
+            if (lumphash[i].lump >= 0)
+            {
+                lumphash[i].first = first;
+                first += lumphash[i].count;
+                lumphash[i].count = 0;
+            }
+
+        for (i = 0; i < numlumps; ++i)
+        {
+            lumphash_t  *entry = W_FindLumpHash(lumpinfo[i].name);
 
-            lumpinfo[i].next = lumphash[hash];
-            lumphash[hash] = &lumpinfo[i];
+            lumpoccurrences[entry->first + entry->count++] = i;
         }
     }
 
+    // Find the lumps between the markers of each namespace
+    for (i = 0; i < NUMLUMPNAMESPACES; ++i)
+    {
+        int     start = W_CheckNumForName(namespaces[i].start);
+        int     end = W_CheckNumForName(namespaces[i].end);
+
+        namespaces[i].found = (start >= 0 && end > start);
+        namespaces[i].first = (namespaces[i].found ? start + 1 : 0);
+        namespaces[i].last = (namespaces[i].found ? end - 1 : -1);
+    }
+
     // All done!
 }
+
+//
+// W_BenchmarkLumpLookups
+// Times generating the hash table, and looking up the name of every lump
+//  with it. Start with -file to include a megawad and several PWADs.
+//
+void W_BenchmarkLumpLookups(int runs)
+{
+    uint64_t            start;
+    uint64_t            buildtime;
+    uint64_t            lookuptime;
+    unsigned int        i;
+    int                 j;
+    int                 probes = 0;
+
+    if (!numlumps)
+        return;
+
+    start = I_GetTimeUS();
+    for (j = 0; j < runs; j++)
+        W_GenerateHashTable();
+    buildtime = I_GetTimeUS() - start;
+
+    start = I_GetTimeUS();
+    for (j = 0; j < runs; j++)
+        for (i = 0; i < numlumps; ++i)
+            if (W_CheckNumForName(lumpinfo[i].name) < 0)
+                I_Error("W_BenchmarkLumpLookups: %.8s not found!", lumpinfo[i].name);
+    lookuptime = I_GetTimeUS() - start;
+
+    for (i = 0; i < numlumps; ++i)
+    {
+        uint64_t        key = W_LumpNameKey(lumpinfo[i].name);
+        unsigned int    slot;
+
+        for (slot = W_LumpHashSlot(key); lumphash[slot].key != key;
+            slot = (slot + 1) & lumphashmask)
+            ++probes;
+        ++probes;
+    }
+
+    C_Output("%s lumps: W_GenerateHashTable %.1f us, W_CheckNumForName %.1f ns per lookup "
+        "(%.2f probes).", commify(numlumps), (double)buildtime / runs,
+        lookuptime * 1000.0 / ((double)runs * numlumps), (double)probes / numlumps);
+}
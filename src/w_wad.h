@@ -65,11 +65,16 @@ struct lumpinfo_s
     int         position;
     int         size;
     void        *cache;
-
-    // Used for hash table lookups
-    lumpinfo_t  *next;
 };
 
+// Namespaces of lumps between markers
+typedef enum
+{
+    ns_flats,
+    ns_sprites,
+    NUMLUMPNAMESPACES
+} lumpnamespace_t;
+
 extern lumpinfo_t *lumpinfo;
 extern unsigned int numlumps;
 
@@ -84,7 +89,11 @@ int W_GetNumForNameX(char *name, unsigned int count);
 
 int W_CheckMultipleLumps(char *name);
 
+boolean W_GetNamespace(lumpnamespace_t ns, int *first, int *last);
+int W_CheckNumForNameInNamespace(char *name, lumpnamespace_t ns);
+
 int W_LumpLength(unsigned int lump);
+void W_PrefetchLumps(int lump, int count);
 void W_ReadLump(unsigned int lump, void *dest);
 
 void *W_CacheLumpNum(int lump, int tag);
@@ -93,10 +102,15 @@ void *W_CacheLumpName(char *name, int tag);
 void W_GenerateHashTable(void);
 
 extern unsigned int W_LumpNameHash(const char *s);
+uint64_t W_LumpNameKey(const char *name);
+void W_BenchmarkLumpLookups(int runs);
 
 void W_ReleaseLumpNum(int lump);
 void W_ReleaseLumpName(char *name);
 
+void W_LockCache(void);
+void W_UnlockCache(void);
+
 int IWADRequiredByPWAD(const char *pwadname);
 boolean IsFreedoom(const char *iwadname);
 boolean HasDehackedLump(const char *pwadname);
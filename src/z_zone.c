@@ -49,6 +49,7 @@ typedef struct memblock
     size_t              size;
     void                **user;
     unsigned char       tag;
+    boolean             arena;
 } memblock_t;
 
 // size of block header
@@ -58,6 +59,78 @@ static const size_t     HEADER_SIZE = (sizeof(memblock_t) + CHUNK_SIZE - 1) & ~(
 
 static memblock_t       *blockbytag[PU_MAX];
 
+//
+// PU_LEVEL and PU_LEVSPEC blocks without a user, that are no larger than
+// ARENA_MAXBLOCK, are carved from ARENA_CHUNKSIZE chunks rather than each
+// malloc'd. They aren't linked into blockbytag[], a block freed with Z_Free
+// goes onto a free list for its size, and Z_FreeTags releases all of them
+// at once by starting again at the first chunk. The chunks are kept to be
+// reused by the next level.
+//
+#define ARENA_CHUNKSIZE (256 * 1024)
+#define ARENA_MAXBLOCK  1024
+
+typedef struct arenachunk_s
+{
+    struct arenachunk_s *next;
+} arenachunk_t;
+
+typedef struct
+{
+    arenachunk_t        *chunks;
+    arenachunk_t        *chunk;         // chunk blocks are being carved from
+    size_t              used;           // bytes of chunk used
+    memblock_t          *freeblocks[ARENA_MAXBLOCK / CHUNK_SIZE + 1];
+} arena_t;
+
+static const size_t     CHUNKHEADER_SIZE = (sizeof(arenachunk_t) + CHUNK_SIZE - 1) & ~(CHUNK_SIZE - 1);
+
+static arena_t          arenas[PU_CACHE];
+
+#define ISARENATAG(tag) ((tag) == PU_LEVEL || (tag) == PU_LEVSPEC)
+
+static memblock_t *Z_ArenaMalloc(arena_t *arena, size_t size)
+{
+    memblock_t  *block = arena->freeblocks[size / CHUNK_SIZE];
+
+    if (block)
+    {
+        arena->freeblocks[size / CHUNK_SIZE] = block->next;
+        return block;
+    }
+
+    if (!arena->chunk || arena->used + HEADER_SIZE + size > ARENA_CHUNKSIZE)
+    {
+        // move on to the next chunk, allocating it if there isn't one yet
+        arenachunk_t    *chunk = (arena->chunk ? arena->chunk->next : arena->chunks);
+
+        if (!chunk)
+        {
+            while (!(chunk = malloc(ARENA_CHUNKSIZE)))
+            {
+                if (!blockbytag[PU_CACHE])
+                    I_Error("Z_Malloc: Failure trying to allocate %lu bytes",
+                        (unsigned long)ARENA_CHUNKSIZE);
+                Z_FreeTags(PU_CACHE, PU_CACHE);
+            }
+
+            chunk->next = NULL;
+            if (arena->chunk)
+                arena->chunk->next = chunk;
+            else
+                arena->chunks = chunk;
+        }
+
+        arena->chunk = chunk;
+        arena->used = CHUNKHEADER_SIZE;
+    }
+
+    block = (memblock_t *)((char *)arena->chunk + arena->used);
+    arena->used += HEADER_SIZE + size;
+
+    return block;
+}
+
 //
 // Z_Malloc
 // You can pass a NULL user if the tag is < PU_PURGELEVEL.
@@ -79,6 +152,17 @@ void *Z_Malloc(size_t size, int tag, void **user)
 
     size = (size + CHUNK_SIZE - 1) & ~(CHUNK_SIZE - 1); // round to chunk size
 
+    if (ISARENATAG(tag) && !user && size <= ARENA_MAXBLOCK)
+    {
+        block = Z_ArenaMalloc(&arenas[tag], size);
+        block->next = block->prev = NULL;
+        block->size = size;
+        block->tag = tag;
+        block->user = NULL;
+        block->arena = true;
+        return ((char *)block + HEADER_SIZE);
+    }
+
     while (!(block = malloc(size + HEADER_SIZE)))
     {
         if (!blockbytag[PU_CACHE])
@@ -103,6 +187,7 @@ void *Z_Malloc(size_t size, int tag, void **user)
 
     block->tag = tag;                                   // tag
     block->user = user;                                 // user
+    block->arena = false;
     block = (memblock_t *)((char *)block + HEADER_SIZE);
     if (user)                                           // if there is a user
         *user = block;                                  // set user to point to new block
@@ -120,6 +205,15 @@ void Z_Free(void *p)
     if (block->user)                                    // Nullify user if one exists
         *block->user = NULL;
 
+    if (block->arena)
+    {
+        arena_t *arena = &arenas[block->tag];
+
+        block->next = arena->freeblocks[block->size / CHUNK_SIZE];
+        arena->freeblocks[block->size / CHUNK_SIZE] = block;
+        return;
+    }
+
     if (block == block->next)
         blockbytag[block->tag] = NULL;
     else if (blockbytag[block->tag] == block)
@@ -142,6 +236,15 @@ void Z_FreeTags(int32_t lowtag, int32_t hightag)
         memblock_t      *block;
         memblock_t      *end_block;
 
+        if (ISARENATAG(lowtag))
+        {
+            arena_t     *arena = &arenas[lowtag];
+
+            arena->chunk = NULL;
+            arena->used = 0;
+            memset(arena->freeblocks, 0, sizeof(arena->freeblocks));
+        }
+
         block = blockbytag[lowtag];
         if (!block)
             continue;
@@ -170,6 +273,10 @@ void Z_ChangeTag(void *ptr, int32_t tag)
     if (tag == block->tag)
         return;
 
+    // blocks in an arena are only released with the rest of it
+    if (block->arena)
+        I_Error("Z_ChangeTag: Unable to change the tag of a block in an arena");
+
     if (block == block->next)
         blockbytag[block->tag] = NULL;
     else if (blockbytag[block->tag] == block)
@@ -197,7 +304,11 @@ void Z_ChangeUser(void *ptr, void **user)
 {
     memblock_t  *block;
 
-    block = (memblock_t *)((byte *)ptr - sizeof(memblock_t));
+    block = (memblock_t *)((char *)ptr - HEADER_SIZE);
+
+    // blocks in an arena have no user to nullify when it's released
+    if (block->arena)
+        I_Error("Z_ChangeUser: Unable to change the user of a block in an arena");
 
     block->user = user;
     *user = ptr;